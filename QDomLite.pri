@@ -12,6 +12,24 @@ DEFINES += QT_USE_QSTRINGBUILDER
 DEFINES += QT_USE_FAST_CONCATENATION
 DEFINES += QT_USE_FAST_OPERATOR_PLUS
 
+qdomlite_statistics {
+    DEFINES += QDOMLITE_STATISTICS
+}
+
+qdomlite_async {
+    QT += concurrent
+}
+
+qdomlite_zlib {
+    DEFINES += QDOMLITE_ZLIB
+    LIBS += -lz
+}
+
+qdomlite_zstd {
+    DEFINES += QDOMLITE_ZSTD
+    LIBS += -lzstd
+}
+
 INCLUDEPATH += $$PWD
 
 HEADERS += $$PWD/qdomlite.h
@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = qdomlitebenchmark
+
+QT += testlib xml
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../QDomLite.pri)
+
+SOURCES += tst_qdomlitebenchmark.cpp
@@ -0,0 +1,559 @@
+#include <QtTest>
+#include <QDomDocument>
+#include <QXmlStreamReader>
+#include <QTemporaryDir>
+#include "qdomlite.h"
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+#endif
+
+namespace BenchmarkAllocations // heap blocks requested by the process, Qt containers and strings included
+{
+std::atomic<qint64> count{0};
+#ifdef __GLIBC__
+bool counted() { return true; }
+#else
+bool counted() { return false; }
+#endif
+}
+
+#ifdef __GLIBC__
+extern "C" void* malloc(size_t size) noexcept
+{
+    BenchmarkAllocations::count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t count, size_t size) noexcept
+{
+    BenchmarkAllocations::count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+extern "C" void* realloc(void* p, size_t size) noexcept
+{
+    BenchmarkAllocations::count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+#endif
+
+struct BenchmarkCorpus
+{
+    QString XML;
+    QByteArray bytes;
+    QString path;
+    int nodes=0;
+};
+
+struct BenchmarkRun // wall time of the iterations QBENCHMARK ran, for the throughput report
+{
+    QElapsedTimer timer;
+    qint64 elapsed=0;
+    qint64 iterations=0;
+    BenchmarkRun() { timer.start(); }
+    void next()
+    {
+        iterations++;
+        elapsed = timer.nsecsElapsed();
+    }
+    double seconds() const { return double(elapsed) / 1e9 / qMax<qint64>(1, iterations); }
+};
+
+namespace BenchmarkModel
+{
+struct Point
+{
+    double x=0;
+    double y=0;
+    bool operator==(const Point& other) const { return (x == other.x) && (y == other.y); }
+};
+struct Shape
+{
+    QString name;
+    int layer=0;
+    QList<Point> points;
+    QString label;
+    bool operator==(const Shape& other) const { return (name == other.name) && (layer == other.layer) && (points == other.points) && (label == other.label); }
+};
+QDOMLITE_BINDING(Point,"point",QDomLite::bindAttribute("x",&Point::x),QDomLite::bindAttribute("y",&Point::y));
+QDOMLITE_BINDING(Shape,"shape",
+                 QDomLite::bindAttribute("name",&Shape::name),
+                 QDomLite::bindAttribute("layer",&Shape::layer),
+                 QDomLite::bindChildren("point",&Shape::points),
+                 QDomLite::bindChild("label",&Shape::label));
+}
+
+namespace BenchmarkLayout
+{
+#pragma pack(push,1)
+struct PackedAttribute // the layout before the cold fields moved out, to measure traversal against
+{
+    QString name;
+    QDomLiteValue value;
+};
+struct PackedElement
+{
+    QList<PackedAttribute*> attributes;
+    QString tag;
+    QDomLiteValue text;
+    QString CDATA;
+    QDomLiteValueList comments;
+    QList<PackedElement*> childElements;
+    ~PackedElement()
+    {
+        qDeleteAll(attributes);
+        qDeleteAll(childElements);
+    }
+};
+#pragma pack(pop)
+}
+
+class QDomLiteBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void fromString_data() { corpusRows(); }
+    void fromString();
+    void fromStringRecycled_data() { corpusRows(); }
+    void fromStringRecycled();
+    void fromByteArray_data() { corpusRows(); }
+    void fromByteArray();
+    void toString_data() { corpusRows(); }
+    void toString();
+    void save_data() { corpusRows(); }
+    void save();
+    void elementsByTagDeep_data() { corpusRows(); }
+    void elementsByTagDeep();
+    void elementByPath_data() { corpusRows(); }
+    void elementByPath();
+    void setAttribute_data() { corpusRows(); }
+    void setAttribute();
+    void updateAttributes_data();
+    void updateAttributes();
+    void wideChildText();
+    void numericText();
+    void boundStruct();
+    void compare_data() { corpusRows(); }
+    void compare();
+    void traversal_data() { corpusRows(); }
+    void traversal();
+    void packedTraversal_data() { corpusRows(); }
+    void packedTraversal();
+    void nodeLayout();
+    void qtXmlDomDocument_data() { corpusRows(); }
+    void qtXmlDomDocument();
+    void qtXmlStreamReader_data() { corpusRows(); }
+    void qtXmlStreamReader();
+private:
+    QMap<QString,BenchmarkCorpus> corpora;
+    QTemporaryDir tempDir;
+    void corpusRows();
+    void addCorpus(const QString& name, const QString& body);
+    const BenchmarkCorpus& currentCorpus();
+    void report(const char* operation, const qint64 bytes, const int nodes, const BenchmarkRun& run);
+    static int countNodes(const QDomLiteElement* e);
+    static qint64 visitNodes(const QDomLiteElement* e);
+    static BenchmarkLayout::PackedElement* packedCopy(const QDomLiteElement* e);
+    static qint64 visitNodes(const BenchmarkLayout::PackedElement* e);
+    static QString firstLeafPath(const QDomLiteElement* e);
+};
+
+void QDomLiteBenchmark::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+    QString body;
+
+    body.clear();
+    for (int i = 0; i < 20000; i++) body += QStringLiteral("<item id=\"%1\">value %1</item>\n").arg(i);
+    addCorpus(QStringLiteral("wide"), QStringLiteral("<root>\n") + body + QStringLiteral("</root>\n"));
+
+    body.clear();
+    for (int b = 0; b < 50; b++)
+    {
+        for (int d = 0; d < 100; d++) body += QStringLiteral("<level%1 depth=\"%1\">\n").arg(d);
+        body += QStringLiteral("<leaf>deep</leaf>\n");
+        for (int d = 99; d >= 0; d--) body += QStringLiteral("</level%1>\n").arg(d);
+    }
+    addCorpus(QStringLiteral("deep"), QStringLiteral("<root>\n") + body + QStringLiteral("</root>\n"));
+
+    body.clear();
+    for (int i = 0; i < 5000; i++)
+    {
+        body += QStringLiteral("<record");
+        for (int a = 0; a < 12; a++) body += QStringLiteral(" attr%1=\"%2\"").arg(a).arg(i * a);
+        body += QStringLiteral("/>\n");
+    }
+    addCorpus(QStringLiteral("attributes"), QStringLiteral("<root>\n") + body + QStringLiteral("</root>\n"));
+
+    body.clear();
+    const QString paragraph = QStringLiteral("Lorem ipsum dolor sit amet, consectetur adipiscing elit. ").repeated(36);
+    for (int i = 0; i < 2000; i++) body += QStringLiteral("<paragraph>") + paragraph + QStringLiteral("</paragraph>\n");
+    addCorpus(QStringLiteral("text"), QStringLiteral("<root>\n") + body + QStringLiteral("</root>\n"));
+
+    body.clear();
+    const QString entities = QStringLiteral("a &lt; b &amp;&amp; c &gt; d &quot;quoted&quot; &apos;single&apos; ").repeated(8);
+    for (int i = 0; i < 5000; i++) body += QStringLiteral("<expression>") + entities + QStringLiteral("</expression>\n");
+    addCorpus(QStringLiteral("entities"), QStringLiteral("<root>\n") + body + QStringLiteral("</root>\n"));
+
+    body.clear();
+    for (int b = 0; b < 200; b++)
+    {
+        for (int d = 0; d < 30; d++) body += QStringLiteral("<node index=\"%1\">\n").arg(d);
+        body += QStringLiteral("<node>leaf</node>\n");
+        for (int d = 0; d < 30; d++) body += QStringLiteral("</node>\n");
+    }
+    addCorpus(QStringLiteral("selfnested"), QStringLiteral("<root>\n") + body + QStringLiteral("</root>\n"));
+}
+
+void QDomLiteBenchmark::addCorpus(const QString& name, const QString& body)
+{
+    BenchmarkCorpus c;
+    c.XML = QStringLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n") + body;
+    c.bytes = c.XML.toUtf8();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    c.nodes = countNodes(doc.documentElement);
+    c.path = firstLeafPath(doc.documentElement);
+    corpora.insert(name, c);
+}
+
+void QDomLiteBenchmark::corpusRows()
+{
+    QTest::addColumn<QString>("corpus");
+    for (const QString& name : corpora.keys()) QTest::newRow(name.toLatin1().constData()) << name;
+}
+
+const BenchmarkCorpus& QDomLiteBenchmark::currentCorpus()
+{
+    QFETCH(QString, corpus);
+    return corpora[corpus];
+}
+
+void QDomLiteBenchmark::report(const char* operation, const qint64 bytes, const int nodes, const BenchmarkRun& run)
+{
+    const double seconds = run.seconds();
+    qInfo().noquote() << QStringLiteral("%1 %2: %3 MB/s, %4 nodes/s")
+                         .arg(QString::fromLatin1(operation), QString::fromLatin1(QTest::currentDataTag()))
+                         .arg(double(bytes) / seconds / 1e6, 0, 'f', 1)
+                         .arg(double(nodes) / seconds, 0, 'f', 0);
+}
+
+int QDomLiteBenchmark::countNodes(const QDomLiteElement* e)
+{
+    e->expand();
+    int count = 1;
+    for (const auto c : e->childElements) count += countNodes(c);
+    return count;
+}
+
+qint64 QDomLiteBenchmark::visitNodes(const QDomLiteElement* e)
+{
+    e->expand();
+    qint64 sum = e->tag.size() + e->text.size() + e->attributeCount();
+    for (const auto c : e->childElements) sum += visitNodes(c);
+    return sum;
+}
+
+BenchmarkLayout::PackedElement* QDomLiteBenchmark::packedCopy(const QDomLiteElement* e)
+{
+    e->expand();
+    auto p = new BenchmarkLayout::PackedElement;
+    for (const auto a : e->attributes) p->attributes.append(new BenchmarkLayout::PackedAttribute{a->name, a->value});
+    p->tag = e->tag;
+    p->text = e->text;
+    p->CDATA = e->CDATA();
+    p->comments = e->comments();
+    for (const auto c : e->childElements) p->childElements.append(packedCopy(c));
+    return p;
+}
+
+qint64 QDomLiteBenchmark::visitNodes(const BenchmarkLayout::PackedElement* e)
+{
+    qint64 sum = e->tag.size() + e->text.size() + e->attributes.size();
+    for (const auto c : e->childElements) sum += visitNodes(c);
+    return sum;
+}
+
+QString QDomLiteBenchmark::firstLeafPath(const QDomLiteElement* e)
+{
+    QStringList path;
+    while (e->childCount())
+    {
+        e = e->firstChild();
+        path.append(e->tag);
+    }
+    return path.join('/');
+}
+
+void QDomLiteBenchmark::fromString()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    BenchmarkRun run;
+    QBENCHMARK { doc.fromString(c.XML); run.next(); }
+    report("fromString", c.bytes.size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::fromStringRecycled()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.setRecycling(true);
+    doc.fromString(c.XML);
+    BenchmarkRun run;
+    QBENCHMARK { doc.fromString(c.XML); run.next(); }
+    QVERIFY(doc.recyclingPool()->reuseCount > 0);
+    report("fromString(recycled)", c.bytes.size(), c.nodes, run);
+    if (!BenchmarkAllocations::counted()) return;
+    qint64 before = BenchmarkAllocations::count.load();
+    doc.fromString(c.XML);
+    const qint64 recycled = BenchmarkAllocations::count.load() - before;
+    QDomLiteDocument fresh;
+    before = BenchmarkAllocations::count.load();
+    fresh.fromString(c.XML);
+    const qint64 allocated = BenchmarkAllocations::count.load() - before;
+    QVERIFY(recycled < allocated);
+    qInfo().noquote() << QStringLiteral("fromString(recycled) %1: %2 allocations, %3 per node, %4 without recycling")
+                         .arg(QString::fromLatin1(QTest::currentDataTag()))
+                         .arg(recycled)
+                         .arg(double(recycled) / c.nodes, 0, 'f', 2)
+                         .arg(allocated);
+}
+
+void QDomLiteBenchmark::fromByteArray()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    BenchmarkRun run;
+    QBENCHMARK { doc.fromByteArray(c.bytes); run.next(); }
+    report("fromByteArray", c.bytes.size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::toString()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    QString out;
+    BenchmarkRun run;
+    QBENCHMARK { out = doc.toString(true); run.next(); }
+    QVERIFY(!out.isEmpty());
+    report("toString", out.toUtf8().size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::save()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    const QString path = tempDir.filePath(QStringLiteral("save.xml"));
+    BenchmarkRun run;
+    QBENCHMARK { QVERIFY(doc.save(path, true)); run.next(); }
+    report("save", QFileInfo(path).size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::elementsByTagDeep()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    const QString tag = c.path.section('/', -1);
+    int found = 0;
+    BenchmarkRun run;
+    QBENCHMARK { found = doc.documentElement->elementsByTag(tag, true).size(); run.next(); }
+    QVERIFY(found > 0);
+    report("elementsByTag(deep)", c.bytes.size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::elementByPath()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    QDomLiteElement* e = nullptr;
+    BenchmarkRun run;
+    QBENCHMARK { e = doc.documentElement->elementByPath(c.path); run.next(); }
+    QVERIFY(e != nullptr);
+    report("elementByPath", c.bytes.size(), c.path.count('/') + 1, run);
+}
+
+void QDomLiteBenchmark::setAttribute()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    const QDomLiteElementList elements = doc.documentElement->elementsByTag(c.path.section('/', 0, 0));
+    int value = 0;
+    auto op = [&]{
+        value++;
+        for (auto e : elements) e->setAttribute(QStringLiteral("touched"), value);
+    };
+    BenchmarkRun run;
+    QBENCHMARK { op(); run.next(); }
+    report("setAttribute", c.bytes.size(), elements.size(), run);
+}
+
+void QDomLiteBenchmark::updateAttributes_data()
+{
+    QTest::addColumn<bool>("bulk");
+    QTest::newRow("setAttribute") << false;
+    QTest::newRow("updateAttributes") << true;
+}
+
+void QDomLiteBenchmark::updateAttributes()
+{
+    QFETCH(bool, bulk);
+    QDomLiteElement e(QStringLiteral("record"));
+    QDomLiteAttributeHash update;
+    for (int i = 0; i < 100; i++)
+    {
+        e.appendAttribute(QStringLiteral("a%1").arg(i), i);
+        update.insert(QStringLiteral("a%1").arg(i * 2), i);
+    }
+    QBENCHMARK {
+        if (bulk) e.updateAttributes(update);
+        else for (auto it = update.constBegin(); it != update.constEnd(); it++) e.setAttribute(it.key(), it.value());
+    }
+    QCOMPARE(e.attributeCount(), 150);
+}
+
+void QDomLiteBenchmark::wideChildText()
+{
+    QDomLiteElement registry(QStringLiteral("registry"));
+    for (int i = 0; i < 50000; i++) registry.appendChild(QStringLiteral("key%1").arg(i))->text = QString::number(i);
+    int sum = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 50000; i += 97) sum += registry.childText(QStringLiteral("key%1").arg(i)).toInt();
+    }
+    QVERIFY(sum > 0);
+}
+
+void QDomLiteBenchmark::numericText()
+{
+    std::vector<double> numbers(100000);
+    for (size_t i = 0; i < numbers.size(); i++) numbers[i] = double(i) * 0.125 - 1000.0;
+    QDomLiteElement e(QStringLiteral("coordinates"));
+    e.text.fromNumbers(numbers);
+    std::vector<double> parsed;
+    QBENCHMARK {
+        e.text.toNumbers(parsed);
+    }
+    QVERIFY(parsed == numbers);
+}
+
+void QDomLiteBenchmark::boundStruct()
+{
+    BenchmarkModel::Shape shape;
+    shape.name = QStringLiteral("outline & fill");
+    shape.layer = 3;
+    shape.label = QStringLiteral("<north>");
+    for (int i = 0; i < 10000; i++) shape.points.append(BenchmarkModel::Point{ i * 0.5, i * -0.25 });
+    const QString XML = QDomLite::writeBound(shape, true);
+    BenchmarkModel::Shape parsed;
+    QBENCHMARK {
+        parsed = BenchmarkModel::Shape();
+        QVERIFY(QDomLite::readBound(QStringView(XML), parsed));
+    }
+    QCOMPARE(parsed, shape);
+}
+
+void QDomLiteBenchmark::compare()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument a;
+    QDomLiteDocument b;
+    a.fromString(c.XML);
+    b.fromString(c.XML);
+    bool equal = false;
+    BenchmarkRun run;
+    QBENCHMARK { equal = a.documentElement->compare(b.documentElement); run.next(); }
+    QVERIFY(equal);
+    report("compare", c.bytes.size(), c.nodes, run);
+
+    // diff, apply and compare again, through the serialized patch
+    b.documentElement->setAttribute(QStringLiteral("revision"), 2);
+    b.documentElement->appendChild(QStringLiteral("added"))->text = QStringLiteral("new");
+    if (b.documentElement->childCount() > 2)
+    {
+        b.documentElement->removeChild(0);
+        b.documentElement->insertChild(b.documentElement->takeChild(b.documentElement->childCount() - 1), 0);
+    }
+    QVERIFY(!a.documentElement->compare(b.documentElement));
+    QDomLiteDiff diff;
+    QDomLitePatch patch;
+    QVERIFY(patch.fromString(diff.diff(a.documentElement, b.documentElement).toString()));
+    QVERIFY(!patch.isEmpty());
+    QVERIFY(patch.apply(a.documentElement));
+    QVERIFY(a.documentElement->compare(b.documentElement));
+    QVERIFY(!patch.fromString(QStringLiteral("<patch><insert path=\"\" index=\"0\"/></patch>")));
+    QVERIFY(!patch.fromString(QStringLiteral("not xml")));
+}
+
+void QDomLiteBenchmark::traversal()
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    qint64 sum = 0;
+    BenchmarkRun run;
+    QBENCHMARK { sum = visitNodes(doc.documentElement); run.next(); }
+    QVERIFY(sum > 0);
+    report("traversal", c.bytes.size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::packedTraversal() // the same walk as traversal over the former packed layout
+{
+    const auto& c = currentCorpus();
+    QDomLiteDocument doc;
+    doc.fromString(c.XML);
+    const QScopedPointer<BenchmarkLayout::PackedElement> packed(packedCopy(doc.documentElement));
+    qint64 sum = 0;
+    BenchmarkRun run;
+    QBENCHMARK { sum = visitNodes(packed.data()); run.next(); }
+    QCOMPARE(sum, visitNodes(doc.documentElement));
+    report("traversal, packed layout", c.bytes.size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::nodeLayout()
+{
+    qInfo().noquote() << QStringLiteral("sizeof(QDomLiteElement)=%1 sizeof(QDomLiteAttribute)=%2 sizeof(QDomLiteElementExtra)=%3 sizeof(CStringMatcher)=%4")
+                         .arg(sizeof(QDomLiteElement)).arg(sizeof(QDomLiteAttribute)).arg(sizeof(QDomLiteElementExtra)).arg(sizeof(CStringMatcher));
+    qInfo().noquote() << QStringLiteral("sizeof(PackedElement)=%1 sizeof(PackedAttribute)=%2 in the packed layout")
+                         .arg(sizeof(BenchmarkLayout::PackedElement)).arg(sizeof(BenchmarkLayout::PackedAttribute));
+    qInfo().noquote() << QStringLiteral("sizeof(QDomLiteAttributeList)=%1 with %2 inline attributes, sizeof(QList<QDomLiteAttribute*>)=%3 before")
+                         .arg(sizeof(QDomLiteAttributeList)).arg(XMLinlineattributes).arg(sizeof(QList<QDomLiteAttribute*>));
+#if XMLinlineattributes <= 1
+    QVERIFY(sizeof(QDomLiteAttributeList) <= sizeof(QList<QDomLiteAttribute*>) + sizeof(QDomLiteAttribute)); // one attribute took the list and a heap attribute before
+#endif
+    QCOMPARE(alignof(QDomLiteElement) % alignof(void*), size_t(0));
+}
+
+void QDomLiteBenchmark::qtXmlDomDocument()
+{
+    const auto& c = currentCorpus();
+    BenchmarkRun run;
+    QBENCHMARK {
+        QDomDocument dom;
+        dom.setContent(c.XML);
+        run.next();
+    }
+    report("QDomDocument::setContent", c.bytes.size(), c.nodes, run);
+}
+
+void QDomLiteBenchmark::qtXmlStreamReader()
+{
+    const auto& c = currentCorpus();
+    auto op = [&]{
+        QXmlStreamReader reader(c.XML);
+        while (!reader.atEnd()) reader.readNext();
+    };
+    BenchmarkRun run;
+    QBENCHMARK { op(); run.next(); }
+    report("QXmlStreamReader", c.bytes.size(), c.nodes, run);
+}
+
+QTEST_GUILESS_MAIN(QDomLiteBenchmark)
+
+#include "tst_qdomlitebenchmark.moc"
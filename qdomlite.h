@@ -1,39 +1,201 @@
 //Quick and Dirty Document Object Model by Thomas Allin. Fast and cheap one-file XML. LGPL v3 license. thomallin@gmail.com
 
+//Source change: QDomLiteElement keeps CDATA and comments in a side allocation, they are no longer public members.
+//Read them with CDATA() and comments(), write them with setCDATA(), setComments(), appendComment() and clearComments().
+
+//Lazy trees (fromStringLazy, loadLazy): an element body is parsed when a member function first needs it.
+//The public fields text and childElements read empty until then, call expand() before reading them directly.
+
 #ifndef QDOMLITE_H
 #define QDOMLITE_H
 
 #include <QString>
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
 #include <QStringRef>
+#include <QTextCodec>
+#include <QScopedPointer>
 #else
 #include <QStringEncoder>
+#include <QStringDecoder>
 #endif
 #include <QVariant>
 #include <QList>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QSet>
+#include <QSharedPointer>
+#include <QMutex>
+#include <QReadWriteLock>
 #include <QStringList>
 #include <QFile>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QHash>
 #include <QTextStream>
+#include <QLocale>
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <atomic>
+#include <type_traits>
+#include <limits>
+#include <vector>
+#include <charconv>
 #include <QRegularExpression>
+#ifdef QDOMLITE_STATISTICS
+#include <QElapsedTimer>
+#include <optional>
+#endif
+#if defined(QT_CONCURRENT_LIB) && (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+#define QDOMLITE_ASYNC
+#include <QtConcurrent>
+#include <QFuture>
+#include <QPromise>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QBuffer>
+#include <numeric>
+#endif
+#ifdef QDOMLITE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef QDOMLITE_ZSTD
+#include <zstd.h>
+#endif
 
 #define XMLmaxtaglen 1000
-#define XMLendtaglen 100
+#ifndef XMLasyncchunksize
+#define XMLasyncchunksize 262144
+#endif
+#ifndef XMLwriterbuffersize
+#define XMLwriterbuffersize 65536
+#endif
+#ifndef XMLinlineattributes
+#define XMLinlineattributes 1 // attributes kept inside the element, each slot adds sizeof(QDomLiteAttribute) to every element
+#endif
+#ifndef XMLattributehashthreshold
+#define XMLattributehashthreshold 8
+#endif
+#ifndef XMLchildindexthreshold
+#define XMLchildindexthreshold 32
+#endif
+#ifndef XMLnumberlength
+#define XMLnumberlength 128
+#endif
 
-static const QRegularExpression rxOther(QStringLiteral("\\s*<!"));
-static const QRegularExpression rxTag(QStringLiteral("\\s*<([^<>/\\s]+)\\s*([^>]*)\\s*>\\s*"));
 static const QRegularExpression rxRemark(QStringLiteral("\\s*<!--(.+)-->\\s*"),QRegularExpression::DotMatchesEverythingOption | QRegularExpression::InvertedGreedinessOption);
 static const QRegularExpression rxAttribute(QStringLiteral("\\s*([^=]+)\\s*=\\s*[\"\']([^\"\']*)[\"\']\\s*"));
 static const QRegularExpression rxdocType(QStringLiteral("\\s*<!doctype(.+)[\[>]\\s*"),QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
-static const QRegularExpression rxXMLAttributes(QStringLiteral("\\s*<\\?xml[^\\s]*(.+)\\?>\\s*"),QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
-static const QRegularExpression rxCDATA(QStringLiteral("\\s*<![\[]CDATA[\[](.+)[\\]][\\]]>"),QRegularExpression::CaseInsensitiveOption | QRegularExpression::DotMatchesEverythingOption | QRegularExpression::InvertedGreedinessOption);
-static const QRegularExpression rxEntityTags(QStringLiteral("\\s*[\[](.+)[\\]]\\s*>\\s*"), QRegularExpression::InvertedGreedinessOption);
+static const QRegularExpression rxEntityTags(QStringLiteral("\\s*[\[](.+)[\\]]\\s*>\\s*"), QRegularExpression::DotMatchesEverythingOption | QRegularExpression::InvertedGreedinessOption);
 static const QRegularExpression rxEntity(QStringLiteral("\\s*<!ENTITY\\s+([^\\s]+).*[\"\'](.+)[\"\']>\\s*"),QRegularExpression::CaseInsensitiveOption | QRegularExpression::InvertedGreedinessOption);
 
 static const QString emptyString;
 
+#ifdef QDOMLITE_STATISTICS
+struct QDomLiteStatistics
+{
+    enum Operation
+    {
+        Parse=0,
+        Serialize=1
+    };
+    enum Phase
+    {
+        CommentScan=0,
+        TagMatch,
+        AttributeParse,
+        EntityDecode,
+        Allocation,
+        EntityEncode,
+        PhaseCount
+    };
+    Operation operation=Parse;
+    qint64 bytesConsumed=0;
+    qint64 charactersConsumed=0;
+    qint64 charactersProduced=0;
+    qint64 elements=0;
+    qint64 attributes=0;
+    qint64 textNodes=0;
+    qint64 comments=0;
+    qint64 entitiesDecoded=0;
+    qint64 allocations=0;
+    int maxDepth=0;
+    int depth=0;
+    qint64 totalTime=0;
+    qint64 phaseTime[PhaseCount]={};
+    inline void reset(const Operation op)
+    {
+        *this=QDomLiteStatistics();
+        operation=op;
+    }
+    inline void enter() { if (++depth > maxDepth) maxDepth=depth; }
+    inline void leave() { depth--; }
+};
+
+typedef std::function<void(const QDomLiteStatistics&)> QDomLiteStatisticsCallback;
+
+namespace QDomLite
+{
+inline QDomLiteStatistics*& activeStatistics()
+{
+    static thread_local QDomLiteStatistics* statistics=nullptr;
+    return statistics;
+}
+}
+
+class QDomLiteStatisticsScope // makes statistics the active ones of this thread, times the operation and reports it when done
+{
+public:
+    inline QDomLiteStatisticsScope(QDomLiteStatistics& statistics, const QDomLiteStatistics::Operation operation, const QDomLiteStatisticsCallback& callback)
+        : statistics(statistics), callback(callback), previous(QDomLite::activeStatistics())
+    {
+        statistics.reset(operation);
+        QDomLite::activeStatistics()=&statistics;
+        timer.start();
+    }
+    inline ~QDomLiteStatisticsScope()
+    {
+        statistics.totalTime=timer.nsecsElapsed();
+        QDomLite::activeStatistics()=previous;
+        if (callback) callback(statistics);
+    }
+private:
+    QDomLiteStatistics& statistics;
+    const QDomLiteStatisticsCallback& callback;
+    QDomLiteStatistics* previous;
+    QElapsedTimer timer;
+};
+
+class QDomLitePhaseTimer
+{
+public:
+    inline QDomLitePhaseTimer() : statistics(QDomLite::activeStatistics()) { if (statistics) timer.start(); }
+    inline void lap(const QDomLiteStatistics::Phase phase)
+    {
+        if (statistics) statistics->phaseTime[phase]+=timer.nsecsElapsed();
+        restart();
+    }
+    inline void restart() { if (statistics) timer.start(); }
+private:
+    QDomLiteStatistics* statistics;
+    QElapsedTimer timer;
+};
+
+#define QDOMLITE_STAT(statement) { if (auto qdomliteStatistics=QDomLite::activeStatistics()) qdomliteStatistics->statement; }
+#define QDOMLITE_STAT_TIMER(timer) QDomLitePhaseTimer timer
+#define QDOMLITE_STAT_LAP(timer,phase) timer.lap(QDomLiteStatistics::phase)
+#define QDOMLITE_STAT_SKIP(timer) timer.restart()
+#else
+#define QDOMLITE_STAT(statement)
+#define QDOMLITE_STAT_TIMER(timer)
+#define QDOMLITE_STAT_LAP(timer,phase)
+#define QDOMLITE_STAT_SKIP(timer)
+#endif
+
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
 #define XMLStringClass QStringView
 #else
@@ -112,8 +274,6 @@ public:
 };
 #endif
 
-#pragma pack(push,1)
-
 class QDomLiteElement;
 class QDomLiteAttribute;
 
@@ -130,8 +290,8 @@ void inline swapElements(QDomLiteElement **x, QDomLiteElement **y)
 class CStringMatcher
 {
 public:
-    inline CStringMatcher(const QChar& c) : needle(c), needleChar(c), ptr(needle.unicode()), size(1) {}
-    inline CStringMatcher(const QString& s) : needle(s), needleChar(s.at(0)), ptr(needle.unicode()), size(s.size()) {}
+    inline CStringMatcher(const QChar& c) : needle(c), ptr(needle.unicode()), size(1), needleChar(c) {}
+    inline CStringMatcher(const QString& s) : needle(s), ptr(needle.unicode()), size(s.size()), needleChar(s.at(0)) {}
     inline bool matches(const QChar& c) const { return (needleChar == c); }
     inline bool matches(const QString& s) const
     {
@@ -166,9 +326,9 @@ public:
     inline const CStringMatcher& operator=(const QChar& c) { return *new CStringMatcher(c); }
     inline const CStringMatcher& operator=(const QString& s) { return *new CStringMatcher(s); }
     const QString needle;
-    const QChar needleChar;
     const QChar* ptr;
     const int size;
+    const QChar needleChar;
 };
 
 class CStringListMatcher
@@ -214,6 +374,50 @@ static const CStringListMatcher entityCharMatcher({">","<","&","\"","'"},{"&gt;"
 
 static const CStringListMatcher trueMatcher({"yes","true","1","-1",QVariant(true).toString().toLower()});
 
+namespace QDomLite
+{
+inline bool isNumberSeparator(const QChar c) { return (c.unicode() == ',') || (c.unicode() == ' ') || (c.unicode() == '\t') || (c.unicode() == '\n') || (c.unicode() == '\r'); }
+template <typename T>
+inline bool numberFromChars(const char* first, const char* last, T& value)
+{
+    if (first < last && *first == '+') // from_chars takes no '+', XML numbers may have one
+    {
+        first++;
+        if (first < last && (*first == '+' || *first == '-')) return false;
+    }
+#ifndef __cpp_lib_to_chars
+    if constexpr (std::is_floating_point<T>::value) // no floating point from_chars in this library, QByteArray parses in the C locale
+    {
+        bool ok;
+        value=T(QByteArray::fromRawData(first,int(last-first)).toDouble(&ok));
+        return ok;
+    }
+    else
+#endif
+    {
+        const auto r=std::from_chars(first,last,value);
+        return (r.ec == std::errc()) && (r.ptr == last);
+    }
+}
+template <typename T>
+inline int numberToChars(char* first, char* last, const T value) // shortest text that reads back to the same value
+{
+#ifndef __cpp_lib_to_chars
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        const QByteArray b=QByteArray::number(double(value),'g',QLocale::FloatingPointShortest);
+        const int n=std::min(int(b.size()),int(last-first));
+        memcpy(first,b.constData(),size_t(n));
+        return n;
+    }
+    else
+#endif
+    {
+        return int(std::to_chars(first,last,value).ptr-first);
+    }
+}
+}
+
 class QDomLiteValue : public QString
 {
 public:
@@ -319,6 +523,70 @@ public:
         return (isNumber) ? bool(retval) : 0;
     }
     inline const QString string() const { return (*this); }
+    template <typename T>
+    inline int toNumbers(T* numbers, const int maxCount) const // whitespace or comma separated, stops at the first token that is not a number or at an empty field between commas
+    {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T,bool>::value,"toNumbers needs an integral or floating point type");
+        const QChar* c=constData();
+        const QChar* const end=c+size();
+        char token[XMLnumberlength];
+        int RetVal=0;
+        while (RetVal < maxCount)
+        {
+            int commas=(RetVal == 0); // a comma before the first number leaves an empty field
+            while (c < end && QDomLite::isNumberSeparator(*c))
+            {
+                if (c->unicode() == ',') commas++;
+                c++;
+            }
+            if (c == end || commas > 1) break;
+            int n=0;
+            while (c < end && !QDomLite::isNumberSeparator(*c))
+            {
+                if (n == XMLnumberlength || c->unicode() > 127) return RetVal;
+                token[n++]=char(c->unicode());
+                c++;
+            }
+            if (!QDomLite::numberFromChars(token,token+n,numbers[RetVal])) break;
+            RetVal++;
+        }
+        return RetVal;
+    }
+    template <typename T>
+    inline int toNumbers(std::vector<T>& numbers) const // replaces the contents of numbers
+    {
+        numbers.resize(size_t(numberCount()));
+        numbers.resize(size_t(toNumbers(numbers.data(),int(numbers.size()))));
+        return int(numbers.size());
+    }
+    inline int numberCount() const // tokens between separators, not checked for being numbers
+    {
+        int RetVal=0;
+        bool inToken=false;
+        for (const QChar c : *this)
+        {
+            const bool separator=QDomLite::isNumberSeparator(c);
+            if (!separator && !inToken) RetVal++;
+            inToken=!separator;
+        }
+        return RetVal;
+    }
+    template <typename T>
+    inline void fromNumbers(const T* numbers, const int n, const QChar separator=QChar::Space)
+    {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T,bool>::value,"fromNumbers needs an integral or floating point type");
+        clear();
+        reserve(n*(std::is_integral<T>::value ? 8 : 16));
+        char token[XMLnumberlength];
+        for (int i = 0; i < n; i++)
+        {
+            if (i) append(separator);
+            append(QLatin1String(token,QDomLite::numberToChars(token,token+XMLnumberlength,numbers[i])));
+        }
+        squeeze();
+    }
+    template <typename T>
+    inline void fromNumbers(const std::vector<T>& numbers, const QChar separator=QChar::Space) { fromNumbers(numbers.data(),int(numbers.size()),separator); }
     //const inline QString encodedString() const
     //{
     //    return toEncodedString();
@@ -331,6 +599,12 @@ public:
     const inline QString encodedString() const {
         QString rich;
         rich.reserve(this->length() * 1.2);
+        appendEncodedString(rich);
+        rich.squeeze();
+        return rich;
+    }
+    inline void appendEncodedString(QString& rich) const {
+        QDOMLITE_STAT_TIMER(statTimer);
         for (int ptr = 0; ptr < this->length(); ptr++)
         {
             const int m = entityCharMatcher.matchIndex(this->at(ptr));
@@ -343,8 +617,7 @@ public:
                 rich += this->at(ptr);
             }
         }
-        rich.squeeze();
-        return rich;
+        QDOMLITE_STAT_LAP(statTimer,EntityEncode);
     }
     inline void fromEncodedString( const QString& str )
     {
@@ -366,6 +639,7 @@ public:
                 {
                     ptr += entityMatcher.matchList.at(m)->size;
                     *this+=entityMatcher.replaceList.at(m);
+                    QDOMLITE_STAT(entitiesDecoded++);
                 }
                 else {
                     *this+=str.at(ptr++);
@@ -407,6 +681,7 @@ public:
                 {
                     position += entityMatcher.matchList.at(m)->size;
                     *this+=entityMatcher.replaceList.at(m);
+                    QDOMLITE_STAT(entitiesDecoded++);
                 }
                 else {
                     *this+=str.at(position++);
@@ -426,7 +701,7 @@ private:
 
 namespace QDomLite
 {
-inline const QDomLiteValue valueFromString(const QString& s) {
+inline QDomLiteValue valueFromString(const QString& s) {
     QDomLiteValue v;
     v.fromEncodedString(s);
     return v;
@@ -434,12 +709,177 @@ inline const QDomLiteValue valueFromString(const QString& s) {
 }
 
 typedef QList<QDomLiteElement*> QDomLiteElementList;
-typedef QList<QDomLiteAttribute*> QDomLiteAttributeList;
 typedef QMap<QString,QDomLiteValue> QDomLiteAttributeMap;
+typedef QHash<QString,QDomLiteValue> QDomLiteAttributeHash;
+typedef QPair<QString,QDomLiteValue> QDomLiteAttributePair;
 typedef QStringList QDomLiteNameList;
 typedef QList<QDomLiteValue> QDomLiteValueList;
 typedef QStringList QDomLiteTagList;
 typedef QMap<QString,QString> QDomLiteEntityMap;
+typedef QSet<QString> QDomLiteStringPool;
+
+struct QDomLiteMemoryUsage
+{
+    qint64 strings=0;
+    qint64 containers=0;
+    qint64 nodes=0;
+    inline qint64 total() const { return strings+containers+nodes; }
+    inline QDomLiteMemoryUsage& operator += (const QDomLiteMemoryUsage& other)
+    {
+        strings+=other.strings;
+        containers+=other.containers;
+        nodes+=other.nodes;
+        return *this;
+    }
+};
+
+namespace QDomLite
+{
+inline qint64 stringMemory(const QString& s, QSet<const void*>& seen)
+{
+    if (s.capacity() == 0) return 0; // null, empty or raw data
+    if (seen.contains(s.constData())) return 0; // implicitly shared, counted once
+    seen.insert(s.constData());
+    return qint64(sizeof(QArrayData)) + (s.capacity() + 1) * qint64(sizeof(QChar));
+}
+template <typename T>
+inline qint64 listMemory(const QList<T>& l)
+{
+    return (l.capacity() == 0) ? 0 : qint64(sizeof(QArrayData)) + l.capacity() * qint64(sizeof(T));
+}
+inline void internString(QDomLiteStringPool& pool, QString& s)
+{
+    if (s.isEmpty())
+    {
+        if (!s.isNull()) s=QString();
+        return;
+    }
+    const auto it=pool.constFind(s);
+    if (it != pool.constEnd())
+    {
+        s=*it;
+        return;
+    }
+    if (s.isDetached()) s.squeeze(); // squeezing a shared string would copy it
+    pool.insert(s);
+}
+inline qint64 valueListMemory(const QList<QDomLiteValue>& l, QSet<const void*>& seen)
+{
+    qint64 retVal=0;
+    for (const QDomLiteValue& v : l) retVal+=stringMemory(v,seen);
+    return retVal;
+}
+inline void compactValueList(QDomLiteStringPool& pool, QList<QDomLiteValue>& l)
+{
+    l.squeeze();
+    for (QDomLiteValue& v : l) internString(pool,v);
+}
+}
+
+class QDomLiteElement;
+class QDomLiteDocument;
+
+class QDomLiteNamePool // tag and attribute names shared by many documents, safe to use from several threads
+{
+public:
+    inline QString name(const QStringView& v) // the pooled copy of v, added when it is new
+    {
+        const size_t h=qHash(v);
+        {
+            QReadLocker locker(&lock);
+            if (const QString* s=find(v,h)) return *s;
+        }
+        QWriteLocker locker(&lock);
+        if (const QString* s=find(v,h)) return *s;
+        return *names.insert(h,v.toString());
+    }
+    inline void intern(QString& s)
+    {
+        if (s.isEmpty()) return;
+        const size_t h=qHash(QStringView(s));
+        {
+            QReadLocker locker(&lock);
+            if (const QString* pooled=find(s,h))
+            {
+                s=*pooled;
+                return;
+            }
+        }
+        QWriteLocker locker(&lock);
+        if (const QString* pooled=find(s,h))
+        {
+            s=*pooled;
+            return;
+        }
+        if (s.isDetached()) s.squeeze();
+        names.insert(h,s);
+    }
+    inline void intern(QDomLiteElement* element);
+    inline void intern(QDomLiteDocument* document);
+    inline int size() const
+    {
+        QReadLocker locker(&lock);
+        return names.size();
+    }
+    inline void clear()
+    {
+        QWriteLocker locker(&lock);
+        names.clear();
+    }
+private:
+    mutable QReadWriteLock lock;
+    QMultiHash<size_t,QString> names; // keyed by the hash of the name, so a QStringView is looked up without a copy
+    inline const QString* find(const QStringView& v, const size_t h) const
+    {
+        for (auto it=names.constFind(h); (it != names.constEnd()) && (it.key() == h); ++it) if (QStringView(*it) == v) return &*it;
+        return nullptr;
+    }
+    inline void internLocal(QString& s, QDomLiteStringPool& local)
+    {
+        const auto it=local.constFind(s);
+        if (it != local.constEnd())
+        {
+            s=*it;
+            return;
+        }
+        intern(s);
+        local.insert(s);
+    }
+    inline void internNames(QDomLiteElement* element, QDomLiteStringPool& local);
+};
+
+namespace QDomLite
+{
+inline QDomLiteNamePool*& activeNamePool() // set while a batch loader parses, names then come from the shared pool
+{
+    static thread_local QDomLiteNamePool* pool=nullptr;
+    return pool;
+}
+inline void assignString(QString& s, const QStringView v)
+{
+    if (auto pool=activeNamePool())
+    {
+        s=pool->name(v);
+        return;
+    }
+    if (s.capacity() < v.size())
+    {
+        s=v.toString();
+        return;
+    }
+    s.resize(0); // keeps the capacity of a recycled string
+    s.append(v);
+}
+}
+
+class QDomLiteNamePoolScope
+{
+public:
+    inline QDomLiteNamePoolScope(QDomLiteNamePool* pool) : previous(QDomLite::activeNamePool()) { QDomLite::activeNamePool()=pool; }
+    inline ~QDomLiteNamePoolScope() { QDomLite::activeNamePool()=previous; }
+private:
+    QDomLiteNamePool* previous;
+};
 
 class QDomLiteAttribute
 {
@@ -449,6 +889,7 @@ public:
         this->name=name;
         this->value=value;
     }
+    inline QDomLiteAttribute(const QString& name, QDomLiteValue&& value) : name(name), value(std::move(value)) {}
     inline QDomLiteAttribute(const QString& XML, int& position) { position=fromString(XML, position); }
     inline QDomLiteAttribute(const QDomLiteAttribute* other) { copy(other); }
     QString name;
@@ -466,7 +907,7 @@ public:
         if (AttrMatch.capturedStart()==start)
         {
             start+=AttrMatch.capturedLength();
-            name = AttrMatch.captured(1);
+            QDomLite::assignString(name,AttrMatch.capturedView(1));
             value.fromEncodedString(AttrMatch.captured(2));
         }
         return start;
@@ -474,10 +915,214 @@ public:
     inline bool matches(const QString& name) const { return (this->name == name); }
 };
 
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+Q_DECLARE_TYPEINFO(QDomLiteAttribute, Q_RELOCATABLE_TYPE);
+#else
+Q_DECLARE_TYPEINFO(QDomLiteAttribute, Q_MOVABLE_TYPE);
+#endif
+
+template <typename T>
+class QDomLiteAttributeIterator
+{
+public:
+    inline QDomLiteAttributeIterator(T* p) : ptr(p) {}
+    inline T* operator*() const { return ptr; }
+    inline T* operator->() const { return ptr; }
+    inline QDomLiteAttributeIterator& operator++()
+    {
+        ++ptr;
+        return *this;
+    }
+    inline bool operator==(const QDomLiteAttributeIterator& other) const { return (ptr == other.ptr); }
+    inline bool operator!=(const QDomLiteAttributeIterator& other) const { return (ptr != other.ptr); }
+private:
+    T* ptr;
+};
+
+// Attributes are stored by value in one array. Pointers from at(), item() or the iterators
+// are only valid until the list changes: an append may reallocate and a removal shifts the rest.
+// The first XMLinlineattributes live inside the list, more spill to one heap block that takes their place.
+class QDomLiteAttributeList
+{
+public:
+    typedef QDomLiteAttributeIterator<QDomLiteAttribute> iterator;
+    typedef QDomLiteAttributeIterator<const QDomLiteAttribute> const_iterator;
+    inline QDomLiteAttributeList() {}
+    inline QDomLiteAttributeList(const QDomLiteAttributeList& other) { append(other); }
+    inline QDomLiteAttributeList(QDomLiteAttributeList&& other) noexcept { moveFrom(other); }
+    inline ~QDomLiteAttributeList()
+    {
+        clear();
+        release();
+    }
+    inline QDomLiteAttributeList& operator=(const QDomLiteAttributeList& other)
+    {
+        if (this == &other) return *this;
+        clear();
+        append(other);
+        return *this;
+    }
+    inline QDomLiteAttributeList& operator=(QDomLiteAttributeList&& other) noexcept
+    {
+        if (this == &other) return *this;
+        clear();
+        release();
+        moveFrom(other);
+        return *this;
+    }
+    inline int size() const { return length; }
+    inline int count() const { return length; }
+    inline int capacity() const { return allocated; }
+    inline bool isEmpty() const { return (length == 0); }
+    inline bool isInline() const { return (allocated <= XMLinlineattributes); }
+    inline QDomLiteAttribute* at(const int index) { return data() + index; }
+    inline const QDomLiteAttribute* at(const int index) const { return data() + index; }
+    inline QDomLiteAttribute* operator[](const int index) { return at(index); }
+    inline const QDomLiteAttribute* operator[](const int index) const { return at(index); }
+    inline QDomLiteAttribute* first() { return at(0); }
+    inline const QDomLiteAttribute* first() const { return at(0); }
+    inline QDomLiteAttribute* last() { return at(length-1); }
+    inline const QDomLiteAttribute* last() const { return at(length-1); }
+    inline int indexOf(const QDomLiteAttribute* a) const // a pointer into this list, -1 for any other
+    {
+        const auto d=data();
+        return ((a >= d) && (a < d + length)) ? int(a-d) : -1;
+    }
+    inline iterator begin() { return iterator(data()); }
+    inline iterator end() { return iterator(data() + length); }
+    inline const_iterator begin() const { return const_iterator(data()); }
+    inline const_iterator end() const { return const_iterator(data() + length); }
+    inline const_iterator constBegin() const { return begin(); }
+    inline const_iterator constEnd() const { return end(); }
+    inline void append(const QDomLiteAttribute& a)
+    {
+        if (length == allocated) append(QDomLiteAttribute(a)); // a may live in this list
+        else new (data() + length++) QDomLiteAttribute(a);
+    }
+    inline void append(QDomLiteAttribute&& a)
+    {
+        if (length == allocated) grow(qMax(allocated*2,4));
+        new (data() + length++) QDomLiteAttribute(std::move(a));
+    }
+    inline void append(QDomLiteAttribute* a) // takes ownership
+    {
+        append(std::move(*a));
+        delete a;
+    }
+    inline void append(const QDomLiteAttributeList& other)
+    {
+        if (this == &other) return append(QDomLiteAttributeList(other));
+        reserve(length + other.length);
+        for (const auto a : other) new (data() + length++) QDomLiteAttribute(*a);
+    }
+    inline void append(QDomLiteAttributeList&& other)
+    {
+        if (isEmpty() && (other.allocated > XMLinlineattributes)) // takes the block
+        {
+            release();
+            moveFrom(other);
+            return;
+        }
+        reserve(length + other.length);
+        for (auto a : other) new (data() + length++) QDomLiteAttribute(std::move(*a));
+        other.clear();
+    }
+    inline void insert(const int index, QDomLiteAttribute&& a)
+    {
+        append(std::move(a));
+        std::rotate(data() + index, data() + length - 1, data() + length);
+    }
+    inline void insert(const int index, const QDomLiteAttribute& a) { insert(index, QDomLiteAttribute(a)); }
+    inline void insert(const int index, QDomLiteAttribute* a) // takes ownership
+    {
+        insert(index, std::move(*a));
+        delete a;
+    }
+    inline QDomLiteAttribute* takeAt(const int index) // the caller owns the returned attribute
+    {
+        auto RetVal=new QDomLiteAttribute(std::move(*at(index)));
+        removeAt(index);
+        return RetVal;
+    }
+    inline void removeAt(const int index)
+    {
+        std::move(data() + index + 1, data() + length, data() + index);
+        data()[--length].~QDomLiteAttribute();
+    }
+    inline void reserve(const int size) { if (size > allocated) grow(size); }
+    inline void squeeze()
+    {
+        if (isInline() || (length == allocated)) return;
+        grow(length);
+    }
+    inline void clear() // keeps the capacity, as recycled elements are filled again
+    {
+        const auto d=data();
+        for (int i = 0; i < length; i++) d[i].~QDomLiteAttribute();
+        length=0;
+    }
+    inline void swap(QDomLiteAttributeList& other)
+    {
+        QDomLiteAttributeList l(std::move(other));
+        other=std::move(*this);
+        *this=std::move(l);
+    }
+private:
+    int length=0;
+    int allocated=XMLinlineattributes;
+#if XMLinlineattributes > 0
+    union
+    {
+        QDomLiteAttribute* heap;
+        alignas(QDomLiteAttribute) char slots[XMLinlineattributes * sizeof(QDomLiteAttribute)];
+    };
+    inline QDomLiteAttribute* inlineData() { return reinterpret_cast<QDomLiteAttribute*>(slots); }
+    inline const QDomLiteAttribute* inlineData() const { return reinterpret_cast<const QDomLiteAttribute*>(slots); }
+#else
+    QDomLiteAttribute* heap;
+    inline QDomLiteAttribute* inlineData() { return nullptr; }
+    inline const QDomLiteAttribute* inlineData() const { return nullptr; }
+#endif
+    inline QDomLiteAttribute* data() { return (isInline()) ? inlineData() : heap; }
+    inline const QDomLiteAttribute* data() const { return (isInline()) ? inlineData() : heap; }
+    inline void grow(const int size) // moves the values to a block of size, or back inside when they fit
+    {
+        QDomLiteAttribute* const old=data();
+        QDomLiteAttribute* const oldHeap=(isInline()) ? nullptr : heap;
+        const int n=qMax(size,int(XMLinlineattributes));
+        QDomLiteAttribute* const d=(n > XMLinlineattributes) ? static_cast<QDomLiteAttribute*>(::operator new(n * sizeof(QDomLiteAttribute))) : inlineData();
+        for (int i = 0; i < length; i++)
+        {
+            new (d + i) QDomLiteAttribute(std::move(old[i]));
+            old[i].~QDomLiteAttribute();
+        }
+        ::operator delete(oldHeap);
+        allocated=n;
+        if (!isInline()) heap=d; // after the move, as the pointer shares its bytes with the inline values
+    }
+    inline void release()
+    {
+        if (!isInline()) ::operator delete(heap);
+        allocated=XMLinlineattributes;
+    }
+    inline void moveFrom(QDomLiteAttributeList& other) // this is empty and holds no block
+    {
+        if (!other.isInline())
+        {
+            heap=std::exchange(other.heap,nullptr);
+            allocated=std::exchange(other.allocated,int(XMLinlineattributes));
+            length=std::exchange(other.length,0);
+            return;
+        }
+        for (auto a : other) new (data() + length++) QDomLiteAttribute(std::move(*a));
+        other.clear();
+    }
+};
+
 namespace QDomLite
 {
 static const QDomLiteAttribute emptyAttribute;
-inline const QDomLiteAttribute attributeFromString(const QString& s) {
+inline QDomLiteAttribute attributeFromString(const QString& s) {
     QDomLiteAttribute a;
     a.fromString(s);
     return a;
@@ -582,7 +1227,8 @@ public:
     inline bool attributeValueBool(const int index, const bool defaultValue) const {
         return (!attributeExists(index)) ? defaultValue : item(index)->value.numericBool();
     }
-    inline void appendAttribute(const QString &name, const QDomLiteValue& value) { attributes.append(new QDomLiteAttribute(name,value)); }
+    inline void appendAttribute(const QString &name, const QDomLiteValue& value) { attributes.append(QDomLiteAttribute(name,value)); }
+    inline void appendAttribute(const QString &name, QDomLiteValue&& value) { attributes.append(QDomLiteAttribute(name,std::move(value))); }
     inline void setAttribute(const QString& name, const QDomLiteValue& value)
     {
         if (value.isEmpty())
@@ -595,7 +1241,7 @@ public:
             appendAttribute(name,value);
             return;
         }
-        for (auto a : std::as_const(attributes))
+        for (auto a : attributes)
         {
             if (a->matches(name))
             {
@@ -624,34 +1270,76 @@ public:
         }
         setAttribute(name,value);
     }
-    inline void setAttributes(const QDomLiteNameList& names, const QDomLiteValueList& values)
+    template <typename T>
+    inline int attributeNumbers(const QString& name, std::vector<T>& numbers) const { return item(name)->value.toNumbers(numbers); }
+    template <typename T>
+    inline void setAttributeNumbers(const QString& name, const std::vector<T>& numbers, const QChar separator=QChar::Space)
     {
-        for (int i=0;i<names.size();i++) setAttribute(names.at(i),values.at(i));
+        QDomLiteValue v;
+        v.fromNumbers(numbers,separator);
+        setAttribute(name,v);
+    }
+    inline void setAttributes(const QDomLiteNameList& names, const QDomLiteValueList& values) { updateAttributes(names,values); }
+    inline void setAttributes(const QDomLiteAttributeMap& map) { updateAttributes(map); }
+    // bulk setAttribute, empty values remove
+    inline void updateAttributes(const QDomLiteNameList& names, const QDomLiteValueList& values)
+    {
+        bulkAttributes([&](auto apply) { for (int i=0;i<names.size();i++) apply(names.at(i),values.at(i)); },true);
     }
-    inline void setAttributes(const QDomLiteAttributeMap& map)
+    inline void updateAttributes(const QDomLiteAttributeMap& map)
     {
-        for (auto it = map.constKeyValueBegin(); it != map.constKeyValueEnd(); it++) setAttribute(it->first,it->second);
-        //for (const QString& s : map.keys()) setAttribute(s,map[s]);
+        bulkAttributes([&](auto apply) { for (auto it = map.constKeyValueBegin(); it != map.constKeyValueEnd(); it++) apply(it->first,it->second); },true);
     }
-    inline void setAttributesString(const QString& attributesString)
+    inline void updateAttributes(const QDomLiteAttributeHash& hash)
     {
-        clearAttributes();
-        appendAttributesString(attributesString);
+        bulkAttributes([&](auto apply) { for (auto it = hash.constBegin(); it != hash.constEnd(); it++) apply(it.key(),it.value()); },true);
     }
-    inline void appendAttributesString(const QString& attributesString)
+    inline void updateAttributes(const QDomLiteAttributePair* pairs, const int count)
     {
-        int start = 0;
-        const int len = attributesString.length() - 1; // skip possible "/"
-        while (start < len)
-        {
-            const int i = start;
-            auto a = new QDomLiteAttribute(attributesString,start);
-            if (i == start)
-            {
-                delete a;
-                break;
-            }
-            attributes.append(a);
+        bulkAttributes([&](auto apply) { for (int i=0;i<count;i++) apply(pairs[i].first,pairs[i].second); },true);
+    }
+    inline void updateAttributes(const QList<QDomLiteAttributePair>& pairs) { updateAttributes(pairs.constData(),pairs.size()); }
+    inline void updateAttributes(std::initializer_list<QDomLiteAttributePair> pairs) { updateAttributes(pairs.begin(),int(pairs.size())); }
+    // adds the attributes that are missing, existing values are kept
+    inline void mergeAttributes(const QDomLiteNameList& names, const QDomLiteValueList& values)
+    {
+        bulkAttributes([&](auto apply) { for (int i=0;i<names.size();i++) apply(names.at(i),values.at(i)); },false);
+    }
+    inline void mergeAttributes(const QDomLiteAttributeMap& map)
+    {
+        bulkAttributes([&](auto apply) { for (auto it = map.constKeyValueBegin(); it != map.constKeyValueEnd(); it++) apply(it->first,it->second); },false);
+    }
+    inline void mergeAttributes(const QDomLiteAttributeHash& hash)
+    {
+        bulkAttributes([&](auto apply) { for (auto it = hash.constBegin(); it != hash.constEnd(); it++) apply(it.key(),it.value()); },false);
+    }
+    inline void mergeAttributes(const QDomLiteAttributePair* pairs, const int count)
+    {
+        bulkAttributes([&](auto apply) { for (int i=0;i<count;i++) apply(pairs[i].first,pairs[i].second); },false);
+    }
+    inline void mergeAttributes(const QList<QDomLiteAttributePair>& pairs) { mergeAttributes(pairs.constData(),pairs.size()); }
+    inline void mergeAttributes(std::initializer_list<QDomLiteAttributePair> pairs) { mergeAttributes(pairs.begin(),int(pairs.size())); }
+    inline void mergeAttributes(const QDomLiteAttributes& other)
+    {
+        bulkAttributes([&](auto apply) { for (const auto a : other.attributes) apply(a->name,a->value); },false);
+    }
+    inline void setAttributesString(const QString& attributesString)
+    {
+        clearAttributes();
+        appendAttributesString(attributesString);
+    }
+    inline void appendAttributesString(const QString& attributesString)
+    {
+        int start = 0;
+        const int len = attributesString.length() - 1; // skip possible "/"
+        while (start < len)
+        {
+            QDomLiteAttribute a;
+            const int i = start;
+            start = a.fromString(attributesString,start);
+            if (i == start) break;
+            attributes.append(std::move(a));
+            QDOMLITE_STAT(attributes++);
         }
     }
     inline void setAttributesMap(const QDomLiteAttributeMap& map)
@@ -659,11 +1347,21 @@ public:
         clearAttributes();
         appendAttributesMap(map);
     }
+    inline void setAttributesMap(QDomLiteAttributeMap&& map)
+    {
+        clearAttributes();
+        appendAttributesMap(std::move(map));
+    }
     inline void appendAttributesMap(const QDomLiteAttributeMap& map)
     {
         for (auto it = map.constKeyValueBegin(); it != map.constKeyValueEnd(); it++) appendAttribute(it->first,it->second);
         //for(const QString& s : map.keys()) appendAttribute(s,map[s]);
     }
+    inline void appendAttributesMap(QDomLiteAttributeMap&& map)
+    {
+        for (auto it = map.begin(); it != map.end(); it++) appendAttribute(it.key(),std::move(it.value()));
+        map.clear();
+    }
     inline void setAttributesLists(const QDomLiteNameList& names, const QDomLiteValueList& values)
     {
         clearAttributes();
@@ -685,17 +1383,17 @@ public:
         for (const auto a : std::as_const(attributes)) l.append(a->value);
         return l;
     }
-    inline void appendAttributes(const QDomLiteAttributeList& attr) { attributes.append(attr); }
+    inline void appendAttributes(QDomLiteAttributeList& attr) { attributes.append(std::move(attr)); } // takes the attributes and leaves attr empty, as with the former pointer list
+    inline void appendAttributes(QDomLiteAttributeList&& attr) { attributes.append(std::move(attr)); }
+    inline void appendAttributes(const QDomLiteAttributeList& attr) { attributes.append(attr); } // copies
     inline void removeAttribute(const QString& name) { removeAttribute(indexOfAttribute(name)); }
     inline void removeAttribute(const int index)
     {
         if (!attributeExists(index)) return;
-        delete attributes.at(index);
-        attributes.erase(attributes.constBegin() + index);
+        attributes.removeAt(index);
     }
     inline void clearAttributes()
     {
-        qDeleteAll(attributes);
         attributes.clear();
     }
     inline int attributeCount() const { return attributes.size(); }
@@ -716,194 +1414,996 @@ public:
     }
     QDomLiteAttributeList attributes;
 protected:
+    inline void attributesMemoryUsage(QDomLiteMemoryUsage& usage, QSet<const void*>& seen) const
+    {
+        if (!attributes.isInline()) usage.containers+=attributes.capacity() * qint64(sizeof(QDomLiteAttribute));
+        for (const auto a : attributes)
+        {
+            usage.strings+=QDomLite::stringMemory(a->name,seen)+QDomLite::stringMemory(a->value,seen);
+        }
+    }
+    inline void compactAttributes(QDomLiteStringPool& pool)
+    {
+        attributes.squeeze();
+        for (auto a : attributes)
+        {
+            QDomLite::internString(pool,a->name);
+            QDomLite::internString(pool,a->value);
+        }
+    }
+    template <typename ForEach>
+    inline void bulkAttributes(ForEach forEach, const bool overwrite) // one pass over the input, names looked up in a temporary hash
+    {
+        QHash<QString,int> index;
+        bool hashed=false;
+        const auto hashWhenLong=[&]() // switches to the hash as soon as the list outgrows a linear scan
+        {
+            if (hashed || (attributes.size() <= XMLattributehashthreshold)) return;
+            hashed=true;
+            index.reserve(attributes.size()*2);
+            for (int i = 0; i < attributes.size(); i++)
+            {
+                if (!index.contains(attributes.at(i)->name)) index.insert(attributes.at(i)->name,i); // the first of duplicate names, as indexOfAttribute finds
+            }
+        };
+        hashWhenLong();
+        QSet<int> removed;
+        forEach([&](const QString& name, const QDomLiteValue& value)
+        {
+            hashWhenLong();
+            int i=-1;
+            if (hashed)
+            {
+                const auto it=index.constFind(name);
+                if (it != index.constEnd()) i=*it;
+            }
+            else
+            {
+                i=indexOfAttribute(name);
+            }
+            if (i < 0)
+            {
+                if (value.isEmpty()) return;
+                if (hashed) index.insert(name,attributes.size());
+                appendAttribute(name,value);
+            }
+            else if (overwrite)
+            {
+                if (value.isEmpty())
+                {
+                    removed.insert(i);
+                    return;
+                }
+                removed.remove(i);
+                attributes.at(i)->value=value;
+            }
+        });
+        if (removed.isEmpty()) return;
+        QDomLiteAttributeList kept;
+        kept.reserve(attributes.size()-removed.size());
+        for (int i = 0; i < attributes.size(); i++) if (!removed.contains(i)) kept.append(std::move(*attributes.at(i)));
+        attributes.swap(kept);
+    }
     inline QDomLiteAttribute* item(const QString& name) const {
-        for (auto a : attributes) if (a->matches(name)) return a;
+        for (auto a : attributes) if (a->matches(name)) return const_cast<QDomLiteAttribute*>(a);
         return const_cast<QDomLiteAttribute*>(&(QDomLite::emptyAttribute));
     }
     inline QDomLiteAttribute* item(const int index) const {
-        return (!attributeExists(index)) ? const_cast<QDomLiteAttribute*>(&(QDomLite::emptyAttribute)) : attributes.at(index);
+        return const_cast<QDomLiteAttribute*>((!attributeExists(index)) ? &(QDomLite::emptyAttribute) : attributes.at(index));
     }
 };
 
-class QDomLiteElement : public QDomLiteAttributes
+class QDomLiteTokenizer
 {
 public:
-    enum QDomLiteElementType
+    enum TokenType
     {
-        UndefinedElement=0,
-        ComplexElement=1,
-        TextElement=2,
-        CDATAElement=4
+        NoToken=0,
+        StartElement=1,
+        EndElement=2,
+        EmptyElement=3,
+        Text=4,
+        CDATA=5,
+        Comment=6,
+        ProcessingInstruction=7,
+        DocType=8,
+        Incomplete=9,
+        Invalid=10
     };
-    inline QDomLiteElement(const QString& Tag) { tag=Tag; }
-    inline QDomLiteElement(const XMLStringClass& XML, int& position) { position=fromString(XML, position); }
-    inline QDomLiteElement(const QString& Tag, const QString& AttrName, const QDomLiteValue& AttrValue) {
-        tag=Tag;
-        appendAttribute(AttrName,AttrValue);
-    }
-    inline QDomLiteElement(const QString &Tag, const QDomLiteNameList& names, const QDomLiteValueList& values)
-    {
-        tag=Tag;
-        appendAttributesLists(names,values);
-    }
-    inline QDomLiteElement(const QString& Tag, const QDomLiteAttributeMap& map)
+    inline QDomLiteTokenizer() {}
+    inline QDomLiteTokenizer(const QStringView& XML, const bool isFinal=true) { setData(XML,isFinal); }
+    inline void setData(const QStringView& XML, const bool isFinal=true, const int start=0)
     {
-        tag=Tag;
-        appendAttributesMap(map);
-    }
-    inline QDomLiteElement() {}
-    inline QDomLiteElement(const QDomLiteElement* other) { copy(other); }
-    inline QDomLiteElement(const QDomLiteElement& other) { copy(&other); }
-    inline ~QDomLiteElement() { clear(); }
-    inline bool isText() const { return !text.isEmpty(); }
-    inline bool isCDATA() const { return !CDATA.isEmpty(); }
-    inline bool isComplex() const { return (text.size()+CDATA.size()==0); }
-    inline QDomLiteElementType elementType() const {
-        if (isText()) return QDomLiteElement::TextElement;
-        if (isCDATA()) return QDomLiteElement::CDATAElement;
-        if (isComplex()) return QDomLiteElement::ComplexElement;
-        return QDomLiteElement::UndefinedElement;
-    }
-    QString tag;
-    QDomLiteValue text;
-    QString CDATA;
-    QDomLiteValueList comments;
-    QDomLiteElementList childElements;
-    inline QDomLiteTagList childTags()
+        data=XML;
+        endOfData=isFinal;
+        position=start;
+        tokenStart=start;
+        tokenType=NoToken;
+        name=QStringView();
+        content=QStringView();
+        scanned=ScanState();
+    }
+    struct ScanState // how far an incomplete token was searched, a longer buffer resumes there instead of rescanning it
     {
-        QDomLiteTagList l;
-        for (const auto e : std::as_const(childElements)) l.append(e->tag);
-        return l;
-    }
-    inline QDomLiteElementList allChildren() const
+        int start=-1;
+        int end=0;
+        ushort quote=0;
+        int subset=0;
+    };
+    inline TokenType next()
     {
-        QDomLiteElementList RetVal;
-        for (auto e : childElements)
+        tokenStart=position;
+        name=QStringView();
+        content=QStringView();
+        const int len=int(data.size());
+        if (position >= len) return tokenType = (endOfData) ? NoToken : Incomplete;
+        const ScanState resume=(scanned.start == position) ? scanned : ScanState();
+        scanned=ScanState();
+        const QChar* s=data.data();
+        if (s[position].unicode() != '<') // text up to the next tag
         {
-            (e->childCount()==0) ? RetVal.append(e) : RetVal.append(e->allChildren());
+            int i=qMax(position,resume.end);
+            while ((i < len) && (s[i].unicode() != '<')) i++;
+            if ((i == len) && !endOfData) return incomplete(len);
+            content=data.mid(position,i-position);
+            position=i;
+            return tokenType=Text;
         }
-        return RetVal;
-    }
-    inline QDomLiteElementList elementsByTag(const QString& name) const
-    {
-        QDomLiteElementList RetVal;
-        for (auto e : childElements) if (e->matches(name)) RetVal.append(e);
-        return RetVal;
-    }
-    inline QDomLiteElement* elementByTag(const QString& name) const
-    {
-        for (auto e : childElements) if (e->matches(name)) return e;
-        return nullptr;
-    }
-    inline QDomLiteElementList elementsByTag(const QString& name, const bool deep) const
-    {
-        QDomLiteElementList RetVal;
-        for (auto e : childElements)
+        if (!endOfData && (len-position < 9)) return incomplete(); // not enough to tell the markup apart
+        const QStringView rest=data.mid(position);
+        if (rest.startsWith(QLatin1String("<!--")))
         {
-            if (e->matches(name)) RetVal.append(e);
-            if (deep) RetVal.append(e->elementsByTag(name,deep));
+            const int e=int(data.indexOf(QLatin1String("-->"),qMax(position+4,resume.end-2)));
+            if (e < 0) return unterminated(len);
+            content=data.mid(position+4,e-position-4);
+            position=e+3;
+            return tokenType=Comment;
         }
-        return RetVal;
-    }
-    inline QDomLiteElement* elementByTag(const QString& name, const bool deep) const
+        if (rest.startsWith(QLatin1String("<![CDATA["),Qt::CaseInsensitive))
+        {
+            const int e=int(data.indexOf(QLatin1String("]]>"),qMax(position+9,resume.end-2)));
+            if (e < 0) return unterminated(len);
+            content=data.mid(position+9,e-position-9);
+            position=e+3;
+            return tokenType=CDATA;
+        }
+        if (rest.startsWith(QLatin1String("<!")))
+        {
+            int subset=resume.subset;
+            QChar quote(resume.quote);
+            int i=qMax(position+2,resume.end);
+            for (; i < len; i++)
+            {
+                const ushort c=s[i].unicode();
+                if (!quote.isNull())
+                {
+                    if (c == quote.unicode()) quote=QChar();
+                }
+                else if ((c == '"') || (c == '\'')) quote=s[i];
+                else if (c == '[') subset++;
+                else if (c == ']') subset--;
+                else if ((c == '>') && (subset <= 0)) break;
+            }
+            if (i >= len) return unterminated(len,quote.unicode(),subset);
+            content=data.mid(position+2,i-position-2);
+            name=tagName(content);
+            position=i+1;
+            return tokenType=DocType;
+        }
+        if (rest.startsWith(QLatin1String("<?")))
+        {
+            const int e=int(data.indexOf(QLatin1String("?>"),qMax(position+2,resume.end-1)));
+            if (e < 0) return unterminated(len);
+            const QStringView pi=data.mid(position+2,e-position-2);
+            name=tagName(pi);
+            content=pi.mid(name.size());
+            position=e+2;
+            return tokenType=ProcessingInstruction;
+        }
+        if (rest.startsWith(QLatin1String("</")))
+        {
+            const int e=int(data.indexOf(QLatin1Char('>'),qMax(position+2,resume.end)));
+            if (e < 0) return unterminated(len);
+            name=data.mid(position+2,e-position-2).trimmed();
+            position=e+1;
+            return tokenType=EndElement;
+        }
+        QChar quote(resume.quote);
+        int i=qMax(position+1,resume.end);
+        for (; i < len; i++)
+        {
+            const ushort c=s[i].unicode();
+            if (!quote.isNull())
+            {
+                if (c == quote.unicode()) quote=QChar();
+            }
+            else if ((c == '"') || (c == '\'')) quote=s[i];
+            else if (c == '>') break;
+        }
+        if (i >= len) return unterminated(len,quote.unicode());
+        const bool empty=(s[i-1].unicode() == '/');
+        const QStringView inner=data.mid(position+1,i-position-1-int(empty));
+        name=tagName(inner);
+        if (name.isEmpty()) return tokenType=Invalid;
+        content=inner.mid(name.size()).trimmed();
+        position=i+1;
+        return tokenType=(empty) ? EmptyElement : StartElement;
+    }
+    inline bool skipElement()
     {
-        QDomLiteElement* RetVal=nullptr;
-        for (auto e : childElements)
+        if (tokenType == EmptyElement) return true;
+        if (tokenType != StartElement) return false;
+        int depth=1;
+        forever
         {
-            if (e->matches(name)) return e;
-            if (deep)
+            switch (next())
             {
-                RetVal=e->elementByTag(name,deep);
-                if (RetVal!=nullptr) return RetVal;
+            case StartElement:
+                depth++;
+                break;
+            case EndElement:
+                if (--depth == 0) return true;
+                break;
+            case NoToken:
+            case Incomplete:
+            case Invalid:
+                return false;
+            default:
+                break;
             }
         }
-        return RetVal;
     }
-    inline QDomLiteElement* elementByTagCreate(const QString& name)
+    static inline bool nextAttribute(const QStringView& s, int& position, QStringView& attributeName, QStringView& attributeValue)
     {
-        for (auto e : std::as_const(childElements)) if (e->matches(name)) return e;
-        return appendChild(name);
+        const int len=int(s.size());
+        while ((position < len) && s.at(position).isSpace()) position++;
+        const int nameStart=position;
+        while ((position < len) && (s.at(position).unicode() != '=') && (s.at(position).unicode() != '/') && !s.at(position).isSpace()) position++;
+        if (position == nameStart) return false;
+        attributeName=s.mid(nameStart,position-nameStart);
+        while ((position < len) && s.at(position).isSpace()) position++;
+        if ((position >= len) || (s.at(position).unicode() != '=')) return false;
+        position++;
+        while ((position < len) && s.at(position).isSpace()) position++;
+        if ((position >= len) || ((s.at(position).unicode() != '"') && (s.at(position).unicode() != '\''))) return false;
+        const QChar quote=s.at(position++);
+        const int valueStart=position;
+        while ((position < len) && (s.at(position) != quote)) position++;
+        if (position >= len) return false;
+        attributeValue=s.mid(valueStart,position-valueStart);
+        position++;
+        return true;
     }
-    inline QDomLiteElement* elementByTagCreate(QDomLiteElement* element)
+    inline const QStringView raw() const { return data.mid(tokenStart,position-tokenStart); }
+    inline bool atEnd() const { return position >= data.size(); }
+    static inline const QStringView tagName(const QStringView& s)
     {
-        for (auto e : std::as_const(childElements)) if (e->matches(element->tag)) return e;
-        return appendClone(element);
-    }
-    inline QDomLiteElement* elementByPath(QStringList list)
+        int i=0;
+        while ((i < s.size()) && !s.at(i).isSpace() && (s.at(i).unicode() != '/') && (s.at(i).unicode() != '>')) i++;
+        return s.left(i);
+    }
+    QStringView data;
+    QStringView name;
+    QStringView content;
+    int position=0;
+    int tokenStart=0;
+    TokenType tokenType=NoToken;
+    bool endOfData=true;
+    ScanState scanned; // set by an Incomplete token, keep it across setData with the offsets moved along the data
+private:
+    inline TokenType incomplete(const int scanEnd=0, const ushort quote=0, const int subset=0)
     {
-        if (list.empty()) return nullptr;
-        auto e = elementByTag(list.takeFirst());
-        if (e) return (list.empty()) ? e : e->elementByPath(list);
-        return nullptr;
+        position=tokenStart;
+        scanned.start=tokenStart;
+        scanned.end=scanEnd;
+        scanned.quote=quote;
+        scanned.subset=subset;
+        return tokenType=Incomplete;
+    }
+    inline TokenType unterminated(const int scanEnd, const ushort quote=0, const int subset=0)
+    {
+        if (!endOfData) return incomplete(scanEnd,quote,subset);
+        return tokenType=Invalid;
     }
-    inline QDomLiteElement* elementByPath(const QString& listString, const QChar& separator = '/')
+};
+
+// QDOMLITE_BINDING(Type,Tag,fields...); goes in the namespace of Type, the functions it declares are found by argument dependent lookup.
+// The field list is fixed at compile time, element and attribute names are still compared as strings while reading.
+// A type binds either a text field or child fields, as the tree keeps no text next to child elements.
+#define QDOMLITE_BINDING(Type,Tag,...) \
+constexpr const char* qDomLiteBindingTag(const Type*) { return Tag; } \
+constexpr auto qDomLiteBindingFields(const Type*) { return std::make_tuple(__VA_ARGS__); }
+
+template <typename T>
+struct QDomLiteBinding
+{
+    static constexpr const char* tag=qDomLiteBindingTag(static_cast<const T*>(nullptr));
+    static constexpr auto fields=qDomLiteBindingFields(static_cast<const T*>(nullptr));
+};
+
+namespace QDomLite
+{
+template <typename C, typename M>
+struct AttributeBinding
+{
+    const char* name;
+    M C::* member;
+};
+template <typename C, typename M>
+struct ChildBinding
+{
+    const char* name;
+    M C::* member;
+};
+template <typename C, typename M>
+struct ChildrenBinding
+{
+    const char* name;
+    QList<M> C::* member;
+};
+template <typename C, typename M>
+struct TextBinding
+{
+    M C::* member;
+};
+template <typename C, typename M>
+constexpr AttributeBinding<C,M> bindAttribute(const char* name, M C::* member) { return {name,member}; }
+template <typename C, typename M>
+constexpr ChildBinding<C,M> bindChild(const char* name, M C::* member) { return {name,member}; }
+template <typename C, typename M>
+constexpr ChildrenBinding<C,M> bindChildren(const char* name, QList<M> C::* member) { return {name,member}; }
+template <typename C, typename M>
+constexpr TextBinding<C,M> bindText(M C::* member) { return {member}; }
+
+template <typename T, typename = void>
+struct isBound : std::false_type {};
+template <typename T>
+struct isBound<T, std::void_t<decltype(qDomLiteBindingFields(std::declval<const T*>()))>> : std::true_type {};
+template <typename F>
+struct isTextField : std::false_type {};
+template <typename C, typename M>
+struct isTextField<TextBinding<C,M>> : std::true_type {};
+template <typename F>
+struct isChildField : std::false_type {};
+template <typename C, typename M>
+struct isChildField<ChildBinding<C,M>> : std::true_type {};
+template <typename C, typename M>
+struct isChildField<ChildrenBinding<C,M>> : std::true_type {};
+template <template <typename> class Is, typename Fields>
+struct anyField;
+template <template <typename> class Is, typename... F>
+struct anyField<Is,std::tuple<F...>> : std::bool_constant<(Is<F>::value || ...)> {};
+template <typename T>
+struct boundFields
+{
+    typedef std::decay_t<decltype(QDomLiteBinding<T>::fields)> Fields;
+    static constexpr bool hasText=anyField<isTextField,Fields>::value;
+    static constexpr bool hasChildren=anyField<isChildField,Fields>::value;
+    static_assert(!(hasText && hasChildren), "QDOMLITE_BINDING: a type binds either a text field or child fields, text mixed with elements is not kept");
+};
+
+template <typename T>
+inline void fromBoundValue(const QDomLiteValue& v, T& value)
+{
+    if constexpr (std::is_same_v<T,bool>) value=v.numericBool();
+    else if constexpr (std::is_enum_v<T>) value=T(v.numericLongLong());
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) value=T(v.numericLongLong());
+    else if constexpr (std::is_integral_v<T>) value=T(v.numericULongLong());
+    else if constexpr (std::is_floating_point_v<T>) value=T(v.numericLDouble());
+    else value=T(v);
+}
+template <typename T>
+inline QDomLiteValue toBoundValue(const T& value)
+{
+    if constexpr (std::is_enum_v<T>) return QDomLiteValue(static_cast<long long>(value));
+    else return QDomLiteValue(value);
+}
+inline bool matchesName(const QStringView& name, const char* bound) { return (name.compare(QLatin1String(bound)) == 0); }
+
+inline bool readBoundText(QDomLiteTokenizer& t, QDomLiteValue& text)
+{
+    QString encoded;
+    QString raw;
+    int depth=1;
+    forever
     {
-        return elementByPath(listString.split(separator));
+        switch (t.next())
+        {
+        case QDomLiteTokenizer::Text:
+            if (depth == 1) encoded.append(t.content);
+            break;
+        case QDomLiteTokenizer::CDATA:
+            if (depth == 1) raw.append(t.content);
+            break;
+        case QDomLiteTokenizer::StartElement:
+            depth++;
+            break;
+        case QDomLiteTokenizer::EndElement:
+            if (--depth == 0)
+            {
+                text.fromEncodedString(encoded.trimmed());
+                text.append(raw);
+                return true;
+            }
+            break;
+        case QDomLiteTokenizer::NoToken:
+        case QDomLiteTokenizer::Incomplete:
+        case QDomLiteTokenizer::Invalid:
+            return false;
+        default:
+            break;
+        }
     }
-    inline QDomLiteElement* elementByPathCreate(QStringList list)
+}
+
+template <typename T>
+inline bool readBoundElement(QDomLiteTokenizer& t, T& object);
+
+template <typename F, typename C>
+inline bool readBoundAttribute(const F&, C&, const QStringView&, const QStringView&) { return false; }
+template <typename C, typename M>
+inline bool readBoundAttribute(const AttributeBinding<C,M>& b, C& object, const QStringView& name, const QStringView& value)
+{
+    if (!matchesName(name,b.name)) return false;
+    QDomLiteValue v;
+    v.fromEncodedString(value);
+    fromBoundValue(v,object.*b.member);
+    return true;
+}
+
+template <typename M>
+inline bool readBoundMember(QDomLiteTokenizer& t, M& member)
+{
+    if constexpr (isBound<M>::value)
     {
-        if (list.empty()) return nullptr;
-        auto e = elementByTagCreate(list.takeFirst());
-        return (list.empty()) ? e : e->elementByPathCreate(list);
+        return readBoundElement(t,member);
     }
-    inline QDomLiteElement* elementByPathCreate(const QString& listString, const QChar& separator = '/')
+    else
     {
-        return elementByPathCreate(listString.split(separator));
+        QDomLiteValue v;
+        if ((t.tokenType == QDomLiteTokenizer::StartElement) && !readBoundText(t,v)) return false;
+        fromBoundValue(v,member);
+        return true;
     }
-    inline double value() const { return text.numeric(); }
-    inline const QDomLiteValue childText(const QString& childTag) const
+}
+template <typename F, typename C>
+inline bool readBoundChild(const F&, QDomLiteTokenizer&, C&, bool&) { return false; }
+template <typename C, typename M>
+inline bool readBoundChild(const ChildBinding<C,M>& b, QDomLiteTokenizer& t, C& object, bool& ok)
+{
+    if (!matchesName(t.name,b.name)) return false;
+    ok=readBoundMember(t,object.*b.member);
+    return true;
+}
+template <typename C, typename M>
+inline bool readBoundChild(const ChildrenBinding<C,M>& b, QDomLiteTokenizer& t, C& object, bool& ok)
+{
+    if (!matchesName(t.name,b.name)) return false;
+    M item{};
+    ok=readBoundMember(t,item);
+    (object.*b.member).append(std::move(item));
+    return true;
+}
+template <typename F, typename C>
+inline void readBoundTextField(const F&, C&, const QDomLiteValue&) {}
+template <typename C, typename M>
+inline void readBoundTextField(const TextBinding<C,M>& b, C& object, const QDomLiteValue& text) { fromBoundValue(text,object.*b.member); }
+
+template <typename T>
+inline bool readBoundElement(QDomLiteTokenizer& t, T& object) // t is positioned on the start tag of object
+{
+    constexpr auto& fields=QDomLiteBinding<T>::fields;
+    const QStringView attributes=t.content;
+    int position=0;
+    QStringView name;
+    QStringView value;
+    while (QDomLiteTokenizer::nextAttribute(attributes,position,name,value))
     {
-        for (int i=0;i<childElements.size();i++) if (childElements.at(i)->tag==childTag) return childElements.at(i)->text;
-        return QDomLiteValue();
+        std::apply([&](const auto&... f){ (readBoundAttribute(f,object,name,value) || ...); },fields);
     }
-    inline double childValue(const QString& childTag) const { return childText(childTag).numeric(); }
-    inline QDomLiteElement* setChild(const QString& name, QDomLiteElement* element) { return replaceChild(elementByTagCreate(name),element); }
-    inline QDomLiteElement* replaceChild(QDomLiteElement* destinationElement, QDomLiteElement* sourceElement)
+    if (t.tokenType == QDomLiteTokenizer::EmptyElement) return true;
+    constexpr bool hasText=boundFields<T>::hasText;
+    QString encoded;
+    QString raw;
+    forever
     {
-        const int index=childElements.indexOf(destinationElement);
-        if (index>-1)
+        switch (t.next())
         {
-            delete childElements.at(index);
-            childElements[index]=sourceElement;
+        case QDomLiteTokenizer::StartElement:
+        case QDomLiteTokenizer::EmptyElement:
+        {
+            bool ok=true;
+            bool handled=false;
+            std::apply([&](const auto&... f){ handled=(readBoundChild(f,t,object,ok) || ...); },fields);
+            if (!handled) ok=t.skipElement();
+            if (!ok) return false;
+            break;
+        }
+        case QDomLiteTokenizer::Text:
+            if (hasText) encoded.append(t.content);
+            break;
+        case QDomLiteTokenizer::CDATA:
+            if (hasText) raw.append(t.content);
+            break;
+        case QDomLiteTokenizer::EndElement:
+        {
+            if (!hasText) return true;
+            QDomLiteValue text;
+            text.fromEncodedString(encoded.trimmed());
+            text.append(raw);
+            std::apply([&](const auto&... f){ (readBoundTextField(f,object,text), ...); },fields);
+            return true;
+        }
+        case QDomLiteTokenizer::NoToken:
+        case QDomLiteTokenizer::Incomplete:
+        case QDomLiteTokenizer::Invalid:
+            return false;
+        default:
+            break;
         }
-        return sourceElement;
     }
-    inline QDomLiteElement* replaceChild(QDomLiteElement* destinationElement, const QString& name) { return replaceChild(destinationElement, new QDomLiteElement(name)); }
-    inline QDomLiteElement* replaceChild(const int index, QDomLiteElement* sourceElement)
+}
+
+template <typename T>
+inline bool readBound(const QStringView& XML, T& object)
+{
+    QDomLiteTokenizer t(XML);
+    forever
     {
-        if (index>-1)
+        switch (t.next())
         {
-            delete childElements.at(index);
-            childElements[index]=sourceElement;
+        case QDomLiteTokenizer::StartElement:
+        case QDomLiteTokenizer::EmptyElement:
+            return matchesName(t.name,QDomLiteBinding<T>::tag) && readBoundElement(t,object);
+        case QDomLiteTokenizer::Text:
+            if (!t.content.trimmed().isEmpty()) return false;
+            break;
+        case QDomLiteTokenizer::NoToken:
+        case QDomLiteTokenizer::Incomplete:
+        case QDomLiteTokenizer::Invalid:
+            return false;
+        default:
+            break;
         }
-        return sourceElement;
     }
-    inline QDomLiteElement* replaceChild(const int index, const QString& name) { return replaceChild(index, new QDomLiteElement(name)); }
-    inline QDomLiteElement* exchangeChild(QDomLiteElement* destinationElement, QDomLiteElement* sourceElement)
+}
+
+template <typename T>
+inline void writeBoundElement(QString& XML, const QLatin1String& tag, const T& object, const int indentLevel);
+
+template <typename F, typename C>
+inline void writeBoundAttribute(const F&, QString&, const C&) {}
+template <typename C, typename M>
+inline void writeBoundAttribute(const AttributeBinding<C,M>& b, QString& XML, const C& object)
+{
+    const QDomLiteValue v=toBoundValue(object.*b.member);
+    if (v.isEmpty()) return;
+    XML+=QChar::Space;
+    XML+=QLatin1String(b.name);
+    XML+=QStringLiteral("=\"");
+    XML+=v.encodedString();
+    XML+='"';
+}
+template <typename M>
+inline void writeBoundMember(QString& XML, const QLatin1String& tag, const M& member, const int indentLevel)
+{
+    if constexpr (isBound<M>::value)
     {
-        const int index=childElements.indexOf(destinationElement);
-        if (index>-1) childElements[index]=sourceElement;
-        return destinationElement;
+        writeBoundElement(XML,tag,member,indentLevel);
     }
-    inline QDomLiteElement* exchangeChild(const int index, QDomLiteElement* sourceElement)
+    else
     {
-        QDomLiteElement* destinationElement=nullptr;
-        if (index>-1)
+        const QDomLiteValue v=toBoundValue(member);
+        XML+=QString(indentLevel,QChar::Tabulation);
+        XML+='<';
+        XML+=tag;
+        if (v.isEmpty())
         {
-            destinationElement=childElements.at(index);
-            childElements[index]=sourceElement;
+            XML+=QStringLiteral("/>\n");
+            return;
         }
-        return destinationElement;
+        XML+='>';
+        XML+=v.encodedString();
+        XML+=QStringLiteral("</");
+        XML+=tag;
+        XML+=QStringLiteral(">\n");
     }
-    inline void removeChild(QDomLiteElement* element)
+}
+template <typename F, typename C>
+inline void writeBoundChild(const F&, QString&, const C&, const int) {}
+template <typename C, typename M>
+inline void writeBoundChild(const ChildBinding<C,M>& b, QString& XML, const C& object, const int indentLevel)
+{
+    writeBoundMember(XML,QLatin1String(b.name),object.*b.member,indentLevel);
+}
+template <typename C, typename M>
+inline void writeBoundChild(const ChildrenBinding<C,M>& b, QString& XML, const C& object, const int indentLevel)
+{
+    for (const M& item : object.*b.member) writeBoundMember(XML,QLatin1String(b.name),item,indentLevel);
+}
+template <typename F, typename C>
+inline void writeBoundText(const F&, QString&, const C&) {}
+template <typename C, typename M>
+inline void writeBoundText(const TextBinding<C,M>& b, QString& XML, const C& object) { XML+=toBoundValue(object.*b.member).encodedString(); }
+
+template <typename T>
+inline void writeBoundElement(QString& XML, const QLatin1String& tag, const T& object, const int indentLevel) // children go straight into XML, the open tag is closed as empty when none was written
+{
+    constexpr auto& fields=QDomLiteBinding<T>::fields;
+    const QString Indent(indentLevel,QChar::Tabulation);
+    XML+=Indent;
+    XML+='<';
+    XML+=tag;
+    std::apply([&](const auto&... f){ (writeBoundAttribute(f,XML,object), ...); },fields);
+    XML+='>';
+    const int content=XML.size();
+    if constexpr (boundFields<T>::hasText)
     {
-        removeChild(childElements.indexOf(element));
+        std::apply([&](const auto&... f){ (writeBoundText(f,XML,object), ...); },fields);
     }
-    inline void removeChild(const int index)
+    else
     {
-        if (!elementExists(index)) return;
-        delete childElements.at(index);
+        XML+=QChar::LineFeed;
+        const int childIndent=(indentLevel>-1) ? indentLevel+1 : -1;
+        std::apply([&](const auto&... f){ (writeBoundChild(f,XML,object,childIndent), ...); },fields);
+        if (XML.size() > content+1) XML+=Indent;
+    }
+    if (XML.size() <= content+int(!boundFields<T>::hasText))
+    {
+        XML.truncate(content-1);
+        XML+=QStringLiteral("/>\n");
+        return;
+    }
+    XML+=QStringLiteral("</");
+    XML+=tag;
+    XML+=QStringLiteral(">\n");
+}
+
+template <typename T>
+inline QString writeBound(const T& object, const bool indent=false)
+{
+    QString XML=QStringLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    writeBoundElement(XML,QLatin1String(QDomLiteBinding<T>::tag),object,-(!indent));
+    return XML;
+}
+}
+
+struct QDomLiteParseOptions
+{
+    enum Option
+    {
+        NoOptions=0,
+        SkipComments=1,
+        SkipCDATA=2,
+        SkipEntities=4, // DOCTYPE entity declarations
+        SkipAttributes=8, // on attributeTags, or on every element when attributeTags is empty
+        SkipWhitespaceText=16
+    };
+    inline QDomLiteParseOptions(const int flags=NoOptions) : flags(flags) {}
+    inline QDomLiteParseOptions(const int flags, const QStringList& tags) : flags(flags), attributeTags(tags.constBegin(),tags.constEnd()) {}
+    inline bool testFlag(const Option option) const { return (flags & option); }
+    inline bool skipsAttributes(const QString& tag) const
+    {
+        if (!(flags & SkipAttributes)) return false;
+        return attributeTags.isEmpty() || attributeTags.contains(tag);
+    }
+    inline bool keepsText(const QStringView& text) const { return !(flags & SkipWhitespaceText) || !text.trimmed().isEmpty(); }
+    int flags;
+    QSet<QString> attributeTags;
+};
+
+struct QDomLiteLazySource
+{
+    inline QDomLiteLazySource(const QString& XML, const QDomLiteParseOptions& options=QDomLiteParseOptions()) : XML(XML), options(options) {}
+    const QString XML;
+    const QDomLiteParseOptions options;
+    QMutex mutex; // one body is expanded at a time
+    static inline bool skipElement(QDomLiteTokenizer& t, QList<int>& childEnds) // t is on a start tag, collects where the bodies of its direct children end
+    {
+        int depth=1;
+        forever
+        {
+            switch (t.next())
+            {
+            case QDomLiteTokenizer::StartElement:
+                depth++;
+                break;
+            case QDomLiteTokenizer::EndElement:
+                if (--depth == 0) return true;
+                if (depth == 1) childEnds.append(t.position);
+                break;
+            case QDomLiteTokenizer::NoToken:
+            case QDomLiteTokenizer::Incomplete:
+            case QDomLiteTokenizer::Invalid:
+                return false;
+            default:
+                break;
+            }
+        }
+    }
+};
+
+struct QDomLiteElementExtra
+{
+    QString CDATA;
+    QDomLiteValueList comments;
+    QSharedPointer<QDomLiteLazySource> lazySource;
+    int lazyStart=0;
+    QList<int> lazyChildEnds; // where the bodies of the child elements end, found while this body was skipped
+    std::atomic<bool> lazyPending{false};
+    QHash<QString,QDomLiteElementList> childIndex; // tag to children in document order, only for wide elements
+    std::atomic<int> childIndexCount{0};
+    std::atomic<bool> childIndexReady{false};
+    QMutex childIndexMutex; // held only while a const lookup builds the index
+    inline bool isEmpty() const { return CDATA.isEmpty() && comments.isEmpty() && !lazyPending.load(std::memory_order_relaxed); }
+};
+
+class QDomLiteElementPool;
+
+namespace QDomLite
+{
+static const QDomLiteElementExtra emptyExtra;
+static const QDomLiteElementList emptyElementList;
+static const QDomLiteParseOptions defaultParseOptions;
+inline QMutex& lazySourceMutex() // guards the source pointer of pending elements, held only to copy or reset it
+{
+    static QMutex mutex;
+    return mutex;
+}
+inline QDomLiteElementPool*& activeElementPool()
+{
+    static thread_local QDomLiteElementPool* pool=nullptr;
+    return pool;
+}
+inline const QDomLiteParseOptions*& activeParseOptions() // set by QDomLiteParseOptionsScope for QDomLiteElement::fromString, nullptr keeps everything
+{
+    static thread_local const QDomLiteParseOptions* options=nullptr;
+    return options;
+}
+inline QDomLiteElement* createElement();
+inline void disposeElement(QDomLiteElement* e);
+}
+
+class QDomLiteElement : public QDomLiteAttributes
+{
+public:
+    enum QDomLiteElementType
+    {
+        UndefinedElement=0,
+        ComplexElement=1,
+        TextElement=2,
+        CDATAElement=4
+    };
+    inline QDomLiteElement(const QString& Tag) { tag=Tag; }
+    inline QDomLiteElement(const XMLStringClass& XML, int& position) { position=fromString(XML, position); }
+    inline QDomLiteElement(const QString& Tag, const QString& AttrName, const QDomLiteValue& AttrValue) {
+        tag=Tag;
+        appendAttribute(AttrName,AttrValue);
+    }
+    inline QDomLiteElement(const QString &Tag, const QDomLiteNameList& names, const QDomLiteValueList& values)
+    {
+        tag=Tag;
+        appendAttributesLists(names,values);
+    }
+    inline QDomLiteElement(const QString& Tag, const QDomLiteAttributeMap& map)
+    {
+        tag=Tag;
+        appendAttributesMap(map);
+    }
+    inline QDomLiteElement() {}
+    inline QDomLiteElement(const QDomLiteElement* other) { copy(other); }
+    inline QDomLiteElement(const QDomLiteElement& other) { copy(&other); }
+    inline QDomLiteElement(QDomLiteElement&& other) noexcept { moveFrom(other); }
+    inline ~QDomLiteElement() { clear(); }
+    inline bool isText() const { expand(); return !text.isEmpty(); }
+    inline bool isCDATA() const { return extra && !extra->CDATA.isEmpty(); }
+    inline bool isComplex() const { expand(); return (text.isEmpty() && !isCDATA()); }
+    inline QDomLiteElementType elementType() const {
+        if (isText()) return QDomLiteElement::TextElement;
+        if (isCDATA()) return QDomLiteElement::CDATAElement;
+        if (isComplex()) return QDomLiteElement::ComplexElement;
+        return QDomLiteElement::UndefinedElement;
+    }
+    QString tag;
+    QDomLiteElementList childElements; // with text, empty on a pending lazy element until expand()
+    QDomLiteValue text;
+    inline const QString& CDATA() const { return extraData().CDATA; }
+    inline void setCDATA(const QString& data)
+    {
+        if (extra || !data.isEmpty()) extraData().CDATA=data;
+    }
+    inline const QDomLiteValueList& comments() const { return extraData().comments; }
+    inline void setComments(const QDomLiteValueList& list)
+    {
+        if (extra || !list.isEmpty()) extraData().comments=list;
+    }
+    inline void appendComment(const QDomLiteValue& comment) { extraData().comments.append(comment); }
+    inline void clearComments()
+    {
+        if (extra) extra->comments.clear();
+    }
+    inline bool isPending() const { return extra && extra->lazyPending.load(std::memory_order_acquire); }
+    // The tag index of wide elements follows the child functions and setTag().
+    // Call this after writing to childElements or to the tag of a child directly, lookups may miss the change otherwise.
+    inline void invalidateChildIndex()
+    {
+        if (!extra)
+        {
+            if (childElements.size() >= XMLchildindexthreshold) extraData(); // holds the index, const lookups build it on first use
+            return;
+        }
+        if (!extra->childIndexReady.load(std::memory_order_relaxed)) return;
+        extra->childIndexReady.store(false,std::memory_order_relaxed);
+        extra->childIndex.clear();
+    }
+    inline void setTag(const QString& name) // renames the element in the tag index of its parent as well
+    {
+        if (parentElement) parentElement->unindexChild(this);
+        tag=name;
+        if (parentElement) parentElement->indexChild(this);
+    }
+    inline void expand() const
+    {
+        if (isPending()) const_cast<QDomLiteElement*>(this)->expandPending();
+    }
+    inline void setPending(const QSharedPointer<QDomLiteLazySource>& source, const int start, const QList<int>& childEnds=QList<int>()) // body starts at start in source
+    {
+        auto& x=extraData();
+        x.lazySource=source;
+        x.lazyStart=start;
+        x.lazyChildEnds=childEnds;
+        x.lazyPending.store(true,std::memory_order_release);
+    }
+    inline QDomLiteTagList childTags()
+    {
+        expand();
+        QDomLiteTagList l;
+        for (const auto e : std::as_const(childElements)) l.append(e->tag);
+        return l;
+    }
+    inline QDomLiteElementList allChildren() const
+    {
+        expand();
+        QDomLiteElementList RetVal;
+        for (auto e : childElements)
+        {
+            (e->childCount()==0) ? RetVal.append(e) : RetVal.append(e->allChildren());
+        }
+        return RetVal;
+    }
+    inline QDomLiteElementList elementsByTag(const QString& name) const
+    {
+        expand();
+        QDomLiteElementList RetVal;
+        if (indexedChildren(name,[&RetVal](const QDomLiteElementList& l) { RetVal=l; })) return RetVal;
+        for (auto e : childElements) if (e->matches(name)) RetVal.append(e);
+        return RetVal;
+    }
+    inline QDomLiteElement* elementByTag(const QString& name) const
+    {
+        expand();
+        QDomLiteElement* RetVal=nullptr;
+        if (indexedChildren(name,[&RetVal](const QDomLiteElementList& l) { RetVal=l.value(0,nullptr); })) return RetVal;
+        for (auto e : childElements) if (e->matches(name)) return e;
+        return nullptr;
+    }
+    inline QDomLiteElementList elementsByTag(const QString& name, const bool deep) const
+    {
+        expand();
+        QDomLiteElementList RetVal;
+        for (auto e : childElements)
+        {
+            if (e->matches(name)) RetVal.append(e);
+            if (deep) RetVal.append(e->elementsByTag(name,deep));
+        }
+        return RetVal;
+    }
+    inline QDomLiteElement* elementByTag(const QString& name, const bool deep) const
+    {
+        expand();
+        QDomLiteElement* RetVal=nullptr;
+        for (auto e : childElements)
+        {
+            if (e->matches(name)) return e;
+            if (deep)
+            {
+                RetVal=e->elementByTag(name,deep);
+                if (RetVal!=nullptr) return RetVal;
+            }
+        }
+        return RetVal;
+    }
+    inline QDomLiteElement* elementByTagCreate(const QString& name)
+    {
+        auto e=elementByTag(name);
+        return (e) ? e : appendChild(name);
+    }
+    inline QDomLiteElement* elementByTagCreate(QDomLiteElement* element)
+    {
+        auto e=elementByTag(element->tag);
+        return (e) ? e : appendClone(element);
+    }
+    inline QDomLiteElement* elementByPath(QStringList list)
+    {
+        if (list.empty()) return nullptr;
+        auto e = elementByTag(list.takeFirst());
+        if (e) return (list.empty()) ? e : e->elementByPath(list);
+        return nullptr;
+    }
+    inline QDomLiteElement* elementByPath(const QString& listString, const QChar& separator = '/')
+    {
+        return elementByPath(listString.split(separator));
+    }
+    inline QDomLiteElement* elementByPathCreate(QStringList list)
+    {
+        if (list.empty()) return nullptr;
+        auto e = elementByTagCreate(list.takeFirst());
+        return (list.empty()) ? e : e->elementByPathCreate(list);
+    }
+    inline QDomLiteElement* elementByPathCreate(const QString& listString, const QChar& separator = '/')
+    {
+        return elementByPathCreate(listString.split(separator));
+    }
+    inline double value() const { expand(); return text.numeric(); }
+    inline const QDomLiteValue childText(const QString& childTag) const
+    {
+        const auto e=elementByTag(childTag);
+        if (!e) return QDomLiteValue();
+        e->expand();
+        return e->text;
+    }
+    inline double childValue(const QString& childTag) const { return childText(childTag).numeric(); }
+    inline QDomLiteElement* setChild(const QString& name, QDomLiteElement* element) { return replaceChild(elementByTagCreate(name),element); }
+    inline QDomLiteElement* replaceChild(QDomLiteElement* destinationElement, QDomLiteElement* sourceElement)
+    {
+        return replaceChild(indexOfChild(destinationElement),sourceElement);
+    }
+    inline QDomLiteElement* replaceChild(QDomLiteElement* destinationElement, const QString& name) { return replaceChild(destinationElement, new QDomLiteElement(name)); }
+    inline QDomLiteElement* replaceChild(const int index, QDomLiteElement* sourceElement)
+    {
+        expand();
+        if (elementExists(index))
+        {
+            unindexChild(childElements.at(index));
+            delete childElements.at(index);
+            childElements[index]=adoptChild(sourceElement,index);
+            indexChild(sourceElement);
+        }
+        return sourceElement;
+    }
+    inline QDomLiteElement* replaceChild(const int index, const QString& name) { return replaceChild(index, new QDomLiteElement(name)); }
+    inline QDomLiteElement* exchangeChild(QDomLiteElement* destinationElement, QDomLiteElement* sourceElement)
+    {
+        exchangeChild(indexOfChild(destinationElement),sourceElement);
+        return destinationElement;
+    }
+    inline QDomLiteElement* exchangeChild(const int index, QDomLiteElement* sourceElement)
+    {
+        expand();
+        QDomLiteElement* destinationElement=nullptr;
+        if (elementExists(index))
+        {
+            unindexChild(childElements.at(index));
+            destinationElement=releaseChild(childElements.at(index));
+            childElements[index]=adoptChild(sourceElement,index);
+            indexChild(sourceElement);
+        }
+        return destinationElement;
+    }
+    inline void removeChild(QDomLiteElement* element)
+    {
+        removeChild(indexOfChild(element));
+    }
+    // Children are kept in one array: a removal or insertion in the middle moves the elements behind it, O(n).
+    // Their positions are renumbered on the next lookup instead, remove many children with removeChildrenIf() or takeChildrenIf().
+    inline void removeChild(const int index)
+    {
+        expand();
+        if (!elementExists(index)) return;
+        unindexChild(childElements.at(index));
+        delete childElements.at(index);
         childElements.erase(childElements.constBegin() + index);
+        stalePositions(index);
     }
     inline void removeChild(const QString& name)
     {
@@ -911,14 +2411,19 @@ public:
         if (element != nullptr) removeChild(element);
     }
     inline void removeFirst() { removeChild(0); }
-    inline void removeLast() { removeChild(childElements.size()-1); }
+    inline void removeLast() { expand(); removeChild(childElements.size()-1); }
     inline QDomLiteElement* takeChild(QDomLiteElement* element)
     {
-        return takeChild(childElements.indexOf(element));
+        return takeChild(indexOfChild(element));
     }
     inline QDomLiteElement* takeChild(const int index)
     {
-        return (!elementExists(index)) ? nullptr : childElements.takeAt(index);
+        expand();
+        if (!elementExists(index)) return nullptr;
+        unindexChild(childElements.at(index));
+        auto element=childElements.takeAt(index);
+        stalePositions(index);
+        return releaseChild(element);
     }
     inline QDomLiteElement* takeChild(const QString& name)
     {
@@ -926,7 +2431,7 @@ public:
         return (element != nullptr) ? takeChild(element) : nullptr;
     }
     inline QDomLiteElement* takeFirst() { return takeChild(0); }
-    inline QDomLiteElement* takeLast() { return takeChild(childElements.size()-1); }
+    inline QDomLiteElement* takeLast() { expand(); return takeChild(childElements.size()-1); }
     inline QDomLiteElement* appendChild(const QString& name)
     {
         return appendChild(new QDomLiteElement(name));
@@ -945,8 +2450,11 @@ public:
     }
     inline QDomLiteElement* appendChild(QDomLiteElement* element)
     {
+        expand();
         if (!element) return nullptr;
-        childElements.append(element);
+        detachChild(element);
+        childElements.append(adoptChild(element,childElements.size()));
+        indexChild(element);
         return element;
     }
     inline QDomLiteElement* appendClone(const QDomLiteElement* element) { return appendChild(new QDomLiteElement(element)); }
@@ -958,8 +2466,12 @@ public:
     }
     inline QDomLiteElement* prependChild(QDomLiteElement* element)
     {
+        expand();
         if (!element) return nullptr;
-        childElements.prepend(element);
+        detachChild(element);
+        childElements.prepend(adoptChild(element,0));
+        stalePositions(1);
+        indexChild(element);
         return element;
     }
     inline QDomLiteElement* prependChild(const QString& name, const QString& attrName, const QDomLiteValue& attrValue)
@@ -976,28 +2488,38 @@ public:
     }
     inline QDomLiteElement* prependClone(const QDomLiteElement* element) { return prependChild(new QDomLiteElement(element)); }
     inline QDomLiteElement* prependChild(const QString& name) { return prependChild(new QDomLiteElement(name)); }
-    inline QDomLiteElement* insertChild(QDomLiteElement* element, const int insertBefore)
+    inline QDomLiteElement* insertChild(QDomLiteElement* element, int insertBefore)
     {
+        expand();
         if (!element) return nullptr;
+        if ((element->parentElement == this) && (indexOfChild(element) < insertBefore)) insertBefore--; // moved within this element
+        detachChild(element);
         if ((insertBefore > -1) && (insertBefore < childElements.size()))
         {
-            childElements.insert(childElements.constBegin() + insertBefore,element);
+            childElements.insert(childElements.constBegin() + insertBefore,adoptChild(element,insertBefore));
+            stalePositions(insertBefore+1);
+            indexChild(element);
         }
         else
         {
-            childElements.append(element);
+            appendChild(element);
         }
         return element;
     }
-    inline QDomLiteElement* insertChild(QDomLiteElement* element, QDomLiteElement* insertBefore) { return insertChild(element,childElements.indexOf(insertBefore)); }
+    inline QDomLiteElement* insertChild(QDomLiteElement* element, QDomLiteElement* insertBefore) { return insertChild(element,indexOfChild(insertBefore)); }
     inline QDomLiteElement* insertChild(const QString& name, const int insertBefore) { return insertChild(new QDomLiteElement(name),insertBefore); }
     inline QDomLiteElement* insertChild(const QString& name, QDomLiteElement* insertBefore) { return insertChild(new QDomLiteElement(name),insertBefore); }
     inline QDomLiteElement* insertClone(const QDomLiteElement* element, const int insertBefore) { return insertChild(new QDomLiteElement(element),insertBefore); }
     inline QDomLiteElement* insertClone(const QDomLiteElement* element, QDomLiteElement* insertBefore) { return insertChild(new QDomLiteElement(element),insertBefore); }
     inline void swapChild(const int index, QDomLiteElement** element)
     {
+        expand();
         if (!elementExists(index)) return;
+        unindexChild(childElements.at(index));
         QDomLite::swapElements(&childElements[index],element);
+        adoptChild(childElements.at(index),index);
+        indexChild(childElements.at(index));
+        releaseChild(*element);
     }
     inline void swapChild(const QString& name, QDomLiteElement** element)
     {
@@ -1006,79 +2528,218 @@ public:
     }
     inline void swapChild(QDomLiteElement* childElement, QDomLiteElement** element)
     {
-        swapChild(childElements.indexOf(childElement),element);
+        swapChild(indexOfChild(childElement),element);
     }
-    inline void appendChildren(QDomLiteElementList& elements) { childElements.append(elements); }
-    inline void insertChildren(QDomLiteElementList& elements, int insertBefore)
+    inline void appendChildren(const QDomLiteElementList& elements) // elements that have a parent leave it, as appendChild does
+    {
+        expand();
+        detachChildren(elements);
+        const int from=childElements.size();
+        childElements.append(elements);
+        reindexChildren(from);
+        invalidateChildIndex();
+    }
+    inline void appendChildren(QDomLiteElementList&& elements)
     {
-        for (auto e : elements)
+        expand();
+        QDomLiteElementList l=std::move(elements);
+        elements.clear();
+        detachChildren(l);
+        const int from=childElements.size();
+        if (childElements.isEmpty())
         {
-            if ((insertBefore > -1) && (insertBefore < childElements.size()))
-            {
-                childElements.insert(childElements.constBegin() + insertBefore++,e);
-            }
-            else
-            {
-                childElements.append(e);
-            }
+            childElements=std::move(l);
         }
+        else
+        {
+            childElements.append(l);
+        }
+        reindexChildren(from);
+        invalidateChildIndex();
     }
-    inline void insertChildren(QDomLiteElementList& elements, QDomLiteElement* insertBefore) { insertChildren(elements, elements.indexOf(insertBefore)); }
+    inline void insertChildren(const QDomLiteElementList& elements, int insertBefore) // elements that have a parent leave it, as insertChild does
+    {
+        expand();
+        if (elements.isEmpty()) return;
+        if ((insertBefore < 0) || (insertBefore >= childElements.size())) insertBefore=childElements.size();
+        for (const auto e : elements) if (e && (e->parentElement == this) && (indexOfChild(e) < insertBefore)) insertBefore--; // moved within this element
+        detachChildren(elements);
+        QDomLiteElementList l;
+        l.reserve(childElements.size()+elements.size());
+        for (int i = 0; i < insertBefore; i++) l.append(childElements.at(i));
+        l.append(elements);
+        for (int i = insertBefore; i < childElements.size(); i++) l.append(childElements.at(i));
+        childElements.swap(l);
+        reindexChildren(insertBefore);
+        invalidateChildIndex();
+    }
+    inline void insertChildren(const QDomLiteElementList& elements, QDomLiteElement* insertBefore) { insertChildren(elements, indexOfChild(insertBefore)); }
     inline void removeChildren(QDomLiteElementList& elements)
     {
-        for (auto e : elements) takeChild(e);
+        const QSet<QDomLiteElement*> s(elements.constBegin(),elements.constEnd());
+        takeChildrenIf([&s](QDomLiteElement* e) { return s.contains(e); });
         qDeleteAll(elements);
         elements.clear();
     }
     inline void removeChildren(const QString& name)
     {
-        auto elements=elementsByTag(name);
-        removeChildren(elements);
+        removeChildrenIf([&name](const QDomLiteElement* e) { return e->matches(name); });
     }
     inline QDomLiteElementList takeChildren(QDomLiteElementList& elements)
     {
+        const QSet<QDomLiteElement*> s(elements.constBegin(),elements.constEnd());
+        const QDomLiteElementList l=takeChildrenIf([&s](QDomLiteElement* e) { return s.contains(e); });
+        const QSet<QDomLiteElement*> taken(l.constBegin(),l.constEnd());
         QDomLiteElementList RetVal;
-        for (auto e : elements) RetVal.append(takeChild(e));
+        RetVal.reserve(elements.size());
+        for (auto e : elements) RetVal.append((taken.contains(e)) ? e : nullptr);
         return RetVal;
     }
     inline QDomLiteElementList takeChildren(const QString& name)
     {
-        auto elements=elementsByTag(name);
-        return takeChildren(elements);
+        return takeChildrenIf([&name](const QDomLiteElement* e) { return e->matches(name); });
     }
-    inline int childCount() const { return childElements.size(); }
+    inline QDomLiteElementList takeChildren(const int from, const int count)
+    {
+        expand();
+        QDomLiteElementList RetVal;
+        if (!elementExists(from) || (count < 1)) return RetVal;
+        const int n=qMin(count,int(childElements.size())-from);
+        RetVal=childElements.mid(from,n);
+        childElements.erase(childElements.constBegin() + from, childElements.constBegin() + from + n);
+        for (auto e : std::as_const(RetVal)) releaseChild(e);
+        reindexChildren(from);
+        invalidateChildIndex();
+        return RetVal;
+    }
+    inline void moveChildren(const int from, const int count, QDomLiteElement* target, int insertBefore=-1)
+    {
+        if (!target) return;
+        const QDomLiteElementList elements=takeChildren(from,count);
+        if ((target == this) && (insertBefore > from)) insertBefore=qMax(from,insertBefore-int(elements.size()));
+        target->insertChildren(elements,insertBefore);
+    }
+    template <typename Predicate>
+    inline int removeChildrenIf(Predicate predicate)
+    {
+        expand();
+        int j=0;
+        for (int i = 0; i < childElements.size(); i++)
+        {
+            auto e=childElements.at(i);
+            if (predicate(e))
+            {
+                delete e;
+                continue;
+            }
+            childElements[j]=adoptChild(e,j);
+            j++;
+        }
+        const int count=childElements.size()-j;
+        childElements.erase(childElements.constBegin() + j, childElements.constEnd());
+        invalidateChildIndex();
+        return count;
+    }
+    template <typename Predicate>
+    inline QDomLiteElementList takeChildrenIf(Predicate predicate)
+    {
+        expand();
+        QDomLiteElementList RetVal;
+        int j=0;
+        for (int i = 0; i < childElements.size(); i++)
+        {
+            auto e=childElements.at(i);
+            if (predicate(e))
+            {
+                RetVal.append(releaseChild(e));
+                continue;
+            }
+            childElements[j]=adoptChild(e,j);
+            j++;
+        }
+        childElements.erase(childElements.constBegin() + j, childElements.constEnd());
+        invalidateChildIndex();
+        return RetVal;
+    }
+    template <typename Predicate>
+    inline int partitionChildren(Predicate predicate)
+    {
+        expand();
+        const auto middle=std::stable_partition(childElements.begin(),childElements.end(),predicate);
+        const int count=int(middle-childElements.begin());
+        reindexChildren();
+        invalidateChildIndex();
+        return count;
+    }
+    inline int childCount() const { expand(); return childElements.size(); }
     inline int childCount(const QString& name) const {
+        expand();
         int count=0;
+        if (indexedChildren(name,[&count](const QDomLiteElementList& l) { count=l.size(); })) return count;
         for (const auto e : childElements) if (e->matches(name)) count++;
         return count;
     }
     inline QDomLiteElement* childElement(const int index) const {
+        expand();
         return (!elementExists(index)) ? nullptr : childElements.at(index);
     }
     inline QDomLiteElement* firstChild() const { return childElement(0); }
-    inline QDomLiteElement* lastChild() const { return childElement(childElements.size()-1); }
-    int inline indexOfChild(QDomLiteElement* element) const { return childElements.indexOf(element); }
+    inline QDomLiteElement* lastChild() const { expand(); return childElement(childElements.size()-1); }
+    int inline indexOfChild(const QDomLiteElement* element) const
+    {
+        expand();
+        if (element && (element->parentElement == this))
+        {
+            renumberChildren();
+            const int position=element->childPosition.load(std::memory_order_relaxed);
+            if (elementExists(position) && (childElements.at(position) == element)) return position;
+        }
+        return int(childElements.indexOf(const_cast<QDomLiteElement*>(element)));
+    }
+    inline QDomLiteElement* parent() const { return parentElement; }
+    inline int indexInParent() const { return (parentElement) ? parentElement->indexOfChild(this) : -1; }
+    inline QDomLiteElement* nextSibling() const
+    {
+        const int index=indexInParent();
+        return (index < 0) ? nullptr : parentElement->childElement(index+1);
+    }
+    inline QDomLiteElement* previousSibling() const
+    {
+        const int index=indexInParent();
+        return (index < 0) ? nullptr : parentElement->childElement(index-1);
+    }
     inline QDomLiteElement* clone() const { return new QDomLiteElement(this); }
     inline void copy(const QDomLiteElement* other)
     {
+        other->expand();
         clear();
         tag=other->tag;
         text=other->text;
-        CDATA=other->CDATA;
-        comments.append(other->comments);
-        for (const auto a : other->attributes) attributes.append(a->clone());
-        for (const auto e : other->childElements) childElements.append(e->clone());
+        if (other->extra)
+        {
+            setCDATA(other->extra->CDATA);
+            setComments(other->extra->comments);
+        }
+        attributes.append(other->attributes);
+        for (const auto e : other->childElements) appendChild(e->clone());
     }
     inline const QString toString(const int indentLevel=-1) const
     {
+        expand();
         const QString Indent(indentLevel,QChar::Tabulation);
-        if (!CDATA.isEmpty()) return Indent+QStringLiteral("<![CDATA[")+CDATA+QStringLiteral("]]>\n");
+        if (isCDATA()) return Indent+QStringLiteral("<![CDATA[")+extra->CDATA+QStringLiteral("]]>\n");
         QString RetVal;
-        for (const QDomLiteValue& c : comments) RetVal+=Indent+QStringLiteral("<!--")+c.encodedString()+QStringLiteral("-->\n");
+        if (extra) for (const QDomLiteValue& c : std::as_const(extra->comments)) RetVal+=Indent+QStringLiteral("<!--")+c.encodedString()+QStringLiteral("-->\n");
+        if (tag.isEmpty()) return RetVal; // the comments after the last child of its parent
         RetVal+=Indent+'<'+tag+attributesString();
+        QDOMLITE_STAT(elements++);
+        QDOMLITE_STAT(enter()); // per element, as fromString counts it
+        QDOMLITE_STAT(attributes+=attributeCount());
+        QDOMLITE_STAT(comments+=comments().size());
         if (!text.isEmpty())
         {
             RetVal+='>'+ text.encodedString()+QStringLiteral("</")+tag+QStringLiteral(">\n");
+            QDOMLITE_STAT(textNodes++);
         }
         else if (!childElements.isEmpty())
         {
@@ -1090,105 +2751,17 @@ public:
         {
             RetVal+=QStringLiteral("/>\n");
         }
+        QDOMLITE_STAT(leave());
         return RetVal;
     }
-    inline int fromString(const XMLStringClass& XML, int start=0)
-    {
-#ifdef QT_DEBUG
-        if (rxOther.matchView(XML.sliced(start,qMin(20,XML.length()-start))).capturedStart()==0)
-#else
-        //if (rxOther.matchView(XML.sliced(start,qMin(20,XML.length()-start))).capturedStart()==0)
-        if (rxOther.matchView(XML.sliced(start,20)).capturedStart()==0)
-#endif
-        {
-            forever // comment
-            {
-                const auto RemarkMatch = rxRemark.matchView(XML,start);
-                if (RemarkMatch.capturedStart()!=start) break;
-                start+=RemarkMatch.capturedLength();
-                comments.append(QDomLite::valueFromString(RemarkMatch.captured(1)));
-            }
-            const auto CDATAMatch = rxCDATA.matchView(XML,start);
-            if (CDATAMatch.capturedStart()==start)
-            {
-                CDATA=CDATAMatch.captured(1);
-                return start+CDATAMatch.capturedLength();
-            }
-        }
-        const auto TagMatch = rxTag.matchView(XML,start);
-        if (TagMatch.capturedStart() == start)
-        {
-            tag=TagMatch.captured(1);
-            const QString Attr(TagMatch.captured(2));
-            start+=TagMatch.capturedLength();
-            if (!Attr.endsWith('/')) //element must have an end tag
-            {
-                const QRegularExpression rxEndTag(QStringLiteral("\\s*</")+tag+QStringLiteral(">\\s*")); //end tag
-                const QRegularExpression rxSameTag(QStringLiteral("<")+tag);
-                const auto EndTagMatch = rxEndTag.matchView(XML,start);
-                const int EndTagPtr = EndTagMatch.capturedStart();
-                const int EndTagLen = EndTagMatch.capturedLength();
-                const int childLen = EndTagPtr - start;
-#ifdef QT_DEBUG
-                const XMLStringClass childString(XML.sliced(start, qMax(0,childLen)));
-#else
-                const XMLStringClass childString(XML.sliced(start, childLen));
-#endif
-                if (!rxSameTag.matchView(childString).hasMatch()) // no nested tags
-                {
-                    int childStart = 0;
-                    while (childStart < childLen)
-                    {
-                        const int i = childStart;
-                        auto e = new QDomLiteElement(childString, childStart);
-                        if (i == childStart)
-                        {
-                            delete e;
-                            if (childStart == 0) {
-                                text.fromEncodedString(childString); // it´s a text element
-                            }
-                            break;
-                        }
-                        childElements.append(e);
-                    }
-                    start = EndTagPtr + EndTagLen; // use end tag found
-                }
-                else // element has nested tags
-                {
-                    forever
-                    {
-                        const int i = start;
-                        auto e = new QDomLiteElement(XML, start);
-                        if (i == start)
-                        {
-                            delete e;
-                            break;
-                        }
-                        childElements.append(e);
-                    }
-#ifdef QT_DEBUG
-                    const auto EndTagMatch = rxEndTag.matchView(XML.sliced(start,qMin(XMLendtaglen,XML.length()-start)));
-#else
-                    //const auto EndTagMatch = rxEndTag.matchView(XML.sliced(start,qMin(XMLendtaglen,XML.length()-start)));
-                    const auto EndTagMatch = rxEndTag.matchView(XML.sliced(start,XMLendtaglen));
-#endif
-                    if (EndTagMatch.capturedStart()==0) // look for new end tag
-                    {
-                        start+=EndTagMatch.capturedLength();
-                    }
-                }
-            }
-            appendAttributesString(Attr);
-        }
-        return start;
-    }
+    inline int fromString(const XMLStringClass& XML, int start=0); // one element, or a CDATA section, with the comments before it, returns start when none parsed
     inline void clear()
     {
+        delete extra; // drops a pending body before clearChildren could expand it
+        extra=nullptr;
         tag.clear();
         text.clear();
-        CDATA.clear();
         clearChildren();
-        comments.clear();
         clearAttributes();
     }
     inline void clear(const QString& Tag)
@@ -1196,10 +2769,61 @@ public:
         clear();
         tag=Tag;
     }
+    inline QDomLiteMemoryUsage memoryUsage() const
+    {
+        QDomLiteMemoryUsage usage;
+        QSet<const void*> seen;
+        memoryUsage(usage,seen);
+        return usage;
+    }
+    inline void memoryUsage(QDomLiteMemoryUsage& usage, QSet<const void*>& seen) const
+    {
+        usage.nodes+=sizeof(QDomLiteElement);
+        usage.strings+=QDomLite::stringMemory(tag,seen)+QDomLite::stringMemory(text,seen);
+        usage.containers+=QDomLite::listMemory(childElements);
+        if (extra)
+        {
+            usage.nodes+=sizeof(QDomLiteElementExtra);
+            usage.strings+=QDomLite::stringMemory(extra->CDATA,seen)+QDomLite::valueListMemory(extra->comments,seen);
+            usage.containers+=QDomLite::listMemory(extra->comments)+QDomLite::listMemory(extra->lazyChildEnds);
+            for (auto it = extra->childIndex.constBegin(); it != extra->childIndex.constEnd(); it++)
+            {
+                usage.containers+=qint64(sizeof(QString)+sizeof(QDomLiteElementList)) + qint64(sizeof(void*)) * 2 + QDomLite::listMemory(it.value()); // hash node, approximate
+                usage.strings+=QDomLite::stringMemory(it.key(),seen);
+            }
+        }
+        attributesMemoryUsage(usage,seen);
+        for (const auto e : childElements) e->memoryUsage(usage,seen);
+    }
+    inline void compact()
+    {
+        QDomLiteStringPool pool;
+        compact(pool);
+    }
+    inline void compact(QDomLiteStringPool& pool)
+    {
+        QDomLite::internString(pool,tag);
+        QDomLite::internString(pool,text);
+        if (extra && extra->isEmpty() && (childElements.size() < XMLchildindexthreshold)) // wide elements keep it for the tag index
+        {
+            delete extra;
+            extra=nullptr;
+        }
+        if (extra)
+        {
+            QDomLite::internString(pool,extra->CDATA);
+            QDomLite::compactValueList(pool,extra->comments);
+        }
+        childElements.squeeze();
+        compactAttributes(pool);
+        for (const auto e : std::as_const(childElements)) e->compact(pool);
+    }
     inline void clearChildren()
     {
+        expand();
         qDeleteAll(childElements);
         childElements.clear();
+        invalidateChildIndex();
     }
     inline bool compare(const QDomLiteElement* element) const
     {
@@ -1219,19 +2843,37 @@ public:
     }
     inline void mergeWith(QDomLiteElement* element) {
         if (element) {
-            for (const auto a : std::as_const(element->attributes)) attributes.append(a->clone());
-            for (const auto e : std::as_const(element->childElements)) childElements.append(e->clone());
+            mergeWith(std::move(*element));
             delete element;
         }
     }
+    inline void mergeWith(QDomLiteElement&& element) {
+        element.expand();
+        attributes.append(std::move(element.attributes));
+        appendChildren(element.takeChildren(0,element.childCount()));
+    }
     inline void mergeWithClone(QDomLiteElement* element) {
         if (element) {
-            for (const auto a : std::as_const(element->attributes)) attributes.append(a->clone());
-            for (const auto e : std::as_const(element->childElements)) childElements.append(e->clone());
+            element->expand();
+            attributes.append(element->attributes);
+            for (const auto e : std::as_const(element->childElements)) appendChild(e->clone());
         }
     }
     inline operator QString() { return toString(0); }
-    inline void operator = (QDomLiteElement& other) { copy(&other); }
+    inline QDomLiteElement& operator = (const QDomLiteElement& other)
+    {
+        if (this != &other) copy(&other);
+        return *this;
+    }
+    inline QDomLiteElement& operator = (QDomLiteElement&& other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            moveFrom(other);
+        }
+        return *this;
+    }
     inline void operator + (QDomLiteElement& other) { mergeWithClone(&other); }
     inline QDomLiteElement& operator += (QDomLiteElement& other) {
         mergeWithClone(&other);
@@ -1260,289 +2902,2889 @@ private:
         return (indentLevel>-1) ? indentLevel+1 : -1;
     }
     inline bool elementExists(const int index) const { return ((index < childElements.size()) && (index >= 0)); }
-};
-
-class QDomLiteDocument : public QDomLiteAttributes
-{
-public:
-    inline QDomLiteDocument(const QString& docType, const QString& docTag)
+    inline const QDomLiteElementExtra& extraData() const { return (extra) ? *extra : QDomLite::emptyExtra; }
+    inline QDomLiteElementExtra& extraData()
     {
-        this->docType=docType;
-        documentElement=new QDomLiteElement(docTag);
-    }
-    inline QDomLiteDocument(const QString& path) {
-        documentElement=new QDomLiteElement;
-        load(path);
-    }
-    inline QDomLiteDocument(const QDomLiteDocument* other) {
-        documentElement=new QDomLiteElement;
-        copy(other);
-    }
-    inline QDomLiteDocument(const QString& path,const QString& defaultType, const QString& defaultTag) {
-        docType=defaultType;
-        documentElement=new QDomLiteElement(defaultTag);
-        if (QFileInfo::exists(path)) load(path);
-    }
-    inline QDomLiteDocument(QIODevice& file) {
-        documentElement=new QDomLiteElement;
-        fromFile(file);
-    }
-    inline QDomLiteDocument(QByteArray& byteArray) {
-        documentElement=new QDomLiteElement;
-        fromByteArray(byteArray);
+        if (!extra) extra=new QDomLiteElementExtra;
+        return *extra;
     }
-    inline QDomLiteDocument() { documentElement=new QDomLiteElement; }
-    inline ~QDomLiteDocument()
+    inline void expandPending();
+    inline void moveFrom(QDomLiteElement& other) noexcept
     {
-        delete documentElement;
+        tag=std::move(other.tag);
+        text=std::move(other.text);
+        attributes=std::move(other.attributes);
+        childElements=std::move(other.childElements);
+        extra=std::exchange(other.extra,nullptr);
+        other.tag.clear();
+        other.text.clear();
+        other.attributes.clear();
+        other.childElements.clear();
+        reindexChildren();
+    }
+    inline void appendParsed(QDomLiteElement* element) // a new child from the parser, which calls invalidateChildIndex() once the element is complete
+    {
+        childElements.append(adoptChild(element,childElements.size()));
     }
-    inline bool fromFile(QIODevice& file) {
-        if (file.isOpen())
-        {
-            fromByteArray(file.readAll());
-            return true;
-        }
-        else
+    inline QDomLiteElement* adoptChild(QDomLiteElement* element, const int index)
+    {
+        if (element)
         {
-            if (file.open(QIODevice::ReadOnly))
-            {
-                fromByteArray(file.readAll());
-                file.close();
-                return true;
-            }
+            element->parentElement=this;
+            element->childPosition.store(index,std::memory_order_relaxed);
         }
-        return false;
-    }
-    inline void fromByteArray(const QByteArray& byteArray) {
-        fromString(decodedByteArray(byteArray));
-    }
-    QDomLiteElement* documentElement;
-    inline QDomLiteElement* replaceDoc(QDomLiteElement* element)
-    {
-        delete documentElement;
-        documentElement = element;
         return element;
     }
-    inline QDomLiteElement* exchangeDoc(QDomLiteElement* element)
-    {
-        QDomLiteElement** t = &documentElement;
-        documentElement = element;
-        return *t;
-    }
-    inline void swapDoc(QDomLiteElement** element)
-    {
-        QDomLite::swapElements(&documentElement,element);
-    }
-    inline bool save(const QString& path, const bool indent = false)
+    inline QDomLiteElement* releaseChild(QDomLiteElement* element)
     {
-        QFile file(path);
-        if(!file.open(QIODevice::WriteOnly)) return false;
-        QTextStream ts( &file );
-        ts << toString(indent);
-        file.close();
-        return true;
+        if (element)
+        {
+            element->parentElement=nullptr;
+            element->childPosition.store(-1,std::memory_order_relaxed);
+        }
+        return element;
     }
-    inline QByteArray toByteArray(const bool indent = false)
+    inline void reindexChildren(const int from=0)
     {
-        QByteArray b;
-        QTextStream ts(&b);
-        ts << toString(indent);
-        return b;
+        for (int i = from; i < childElements.size(); i++) adoptChild(childElements.at(i),i);
+        if (from <= firstStalePosition.load(std::memory_order_relaxed)) firstStalePosition.store(std::numeric_limits<int>::max(),std::memory_order_relaxed);
     }
-    inline bool load(const QString& path)
+    inline void stalePositions(const int from) // a removal or insertion leaves the positions behind it to renumberChildren, so it does not touch every sibling
     {
-        QFile fileData(path);
-        return fromFile(fileData);
+        if (from < firstStalePosition.load(std::memory_order_relaxed)) firstStalePosition.store(from,std::memory_order_relaxed);
     }
-    inline void clear()
+    inline void renumberChildren() const
     {
-        docType.clear();
-        comments.clear();
-        entities.clear();
-        documentElement->clear();
-        clearAttributes();
+        const int from=firstStalePosition.load(std::memory_order_acquire);
+        if (from >= childElements.size()) return;
+        for (int i = from; i < childElements.size(); i++) if (auto e=childElements.at(i)) e->childPosition.store(i,std::memory_order_relaxed); // concurrent const lookups write the same numbers
+        firstStalePosition.store(std::numeric_limits<int>::max(),std::memory_order_release);
     }
-    inline void clear(const QString& docType, const QString& docTag)
+    inline void detachChild(QDomLiteElement* element) // an element that still has a parent leaves it before it moves
     {
-        clear();
-        this->docType=docType;
-        documentElement->tag=docTag;
+        if (element->parentElement) element->parentElement->takeChild(element);
     }
-    inline void fromString(const XMLStringClass& XML)
+    static inline void detachChildren(const QDomLiteElementList& elements) // one pass over each former parent
     {
-        clear();
-        int Ptr = 0;
-        while (appendComments(XML, Ptr)){}
-        const auto DocTypeMatch = rxdocType.matchView(XML, Ptr);
-        if (DocTypeMatch.capturedStart() == Ptr)
+        QHash<QDomLiteElement*,QSet<QDomLiteElement*>> parents;
+        for (const auto e : elements) if (e && e->parentElement) parents[e->parentElement].insert(e);
+        for (auto it = parents.cbegin(); it != parents.cend(); it++)
         {
-            docType=DocTypeMatch.captured(1);
-            Ptr+=DocTypeMatch.capturedLength();
-            const auto EntityMatch = rxEntityTags.matchView(XML, Ptr - 1);
-            if (EntityMatch.capturedStart() == Ptr - 1)
-            {
-                const QString ent(EntityMatch.captured(1));
-                int eptr = 0;
-                while (appendEntities(ent, eptr)){}
-                Ptr+=EntityMatch.capturedLength();
-            }
+            const QSet<QDomLiteElement*>& s=it.value();
+            it.key()->takeChildrenIf([&s](QDomLiteElement* e) { return s.contains(e); });
         }
-        while (appendComments(XML, Ptr)){}
-        documentElement->fromString(XML, Ptr);
-    }
-    inline QDomLiteDocument* clone() const { return new QDomLiteDocument(this); }
-    inline void copy(const QDomLiteDocument* other)
-    {
-        clear();
-        docType=other->docType;
-        comments=other->comments;
-        entities=other->entities;
-        for (const auto a : other->attributes) attributes.append(a->clone());
-        replaceDoc(other->documentElement->clone());
     }
-    inline const QString toString(const bool indent=false) const
+    template <typename Found>
+    inline bool indexedChildren(const QString& name, Found found) const // false when the caller has to scan, lookups only lock to build the index
     {
-        QString RetVal = (!attributes.isEmpty()) ? QStringLiteral("<?xml") + attributesString() + QStringLiteral("?>\n") :
-                                                   QStringLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-        if (!docType.isEmpty())
+        if (!extra || (childElements.size() < XMLchildindexthreshold)) return false; // the mutators give wide elements the extra, it is never created here
+        if (!extra->childIndexReady.load(std::memory_order_acquire) || (extra->childIndexCount.load(std::memory_order_acquire) != childElements.size()))
         {
-            RetVal += QStringLiteral("<!DOCTYPE ")+docType;
-            if (!entities.isEmpty())
+            QMutexLocker locker(&extra->childIndexMutex); // concurrent const lookups may race to build it
+            if (!extra->childIndexReady.load(std::memory_order_acquire) || (extra->childIndexCount.load(std::memory_order_acquire) != childElements.size()))
             {
-                RetVal+=QStringLiteral(" [\n");
-                for (auto it = entities.constKeyValueBegin(); it != entities.constKeyValueEnd(); it++)
-                {
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-                    RetVal+=QStringLiteral("<!ENTITY ")+it->first.midRef(1,it->first.size()-2)+QStringLiteral(" \"")+it->second+QStringLiteral("\">\n");
-#else
-                    RetVal+=QStringLiteral("<!ENTITY ")+it->first.mid(1,it->first.size()-2)+QStringLiteral(" \"")+it->second+QStringLiteral("\">\n");
-#endif
-                }
-                RetVal+=QStringLiteral("] ");
+                const_cast<QDomLiteElement*>(this)->buildChildIndex();
             }
-            RetVal+=QStringLiteral(">\n");
         }
-        for (const QDomLiteValue& c : comments) RetVal += QStringLiteral("<!-- ")+c.encodedString()+QStringLiteral("-->\n");
-        return RetVal + documentElement->toString(-(!indent));
-    }
-    inline const QString decodeEntities(QDomLiteElement* textElement) const
-    {
-        return decodeEntities(textElement->text);
+        const auto it=extra->childIndex.constFind(name);
+        found((it == extra->childIndex.constEnd()) ? QDomLite::emptyElementList : *it);
+        return true;
     }
-    inline const QString decodeEntities(const QString& text) const
+    inline void buildChildIndex() // with the index mutex held
     {
-        if (entities.isEmpty()) return text;
-        QString retVal(text);
-        for (auto it = entities.constKeyValueBegin(); it != entities.constKeyValueEnd(); it++) retVal.replace(it->first,it->second);
-        return retVal;
-    }
-    inline void addEntity(const QString& entity, const QString& value)
+        extra->childIndexReady.store(false,std::memory_order_relaxed);
+        extra->childIndexCount.store(-1,std::memory_order_relaxed);
+        extra->childIndex.clear();
+        extra->childIndex.reserve(childElements.size());
+        for (const auto e : std::as_const(childElements)) if (e) extra->childIndex[e->tag].append(e);
+        extra->childIndexCount.store(childElements.size(),std::memory_order_release);
+        extra->childIndexReady.store(true,std::memory_order_release);
+    }
+    inline void indexChild(QDomLiteElement* element) // after element got its final position
     {
-        QString e = entity;
-        if (!e.startsWith('&')) e = '&' + e;
-        if (!e.endsWith(';')) e += ';';
-        entities.insert(e, value);
+        if (!extra || !extra->childIndexReady.load(std::memory_order_relaxed))
+        {
+            invalidateChildIndex();
+            return;
+        }
+        extra->childIndexCount.fetch_add(1,std::memory_order_relaxed); // counts childElements, null entries are left out of the index
+        if (!element) return;
+        renumberChildren(); // the list is ordered by position
+        auto& l=extra->childIndex[element->tag];
+        l.insert(std::lower_bound(l.begin(),l.end(),element,[](const QDomLiteElement* a, const QDomLiteElement* b) { return a->childPosition.load(std::memory_order_relaxed) < b->childPosition.load(std::memory_order_relaxed); }),element);
     }
-    QString docType;
-    QDomLiteValueList comments;
-    QDomLiteEntityMap entities;
-    inline operator QString() { return toString(true); }
-private:
-    const char *UTF_16_BE_BOM = "\xFE\xFF";
-    const char *UTF_16_LE_BOM = "\xFF\xFE";
-    const char *UTF_8_BOM = "\xEF\xBB\xBF";
-    const char *UTF_32_BE_BOM = "\x00\x00\xFE\xFF";
-    const char *UTF_32_LE_BOM = "\xFF\xFE\x00\x00";
-    QString check_bom(const char *data, size_t size)
+    inline void unindexChild(const QDomLiteElement* element) // before element leaves childElements
     {
-        if (size >= 3) {
-            if (memcmp(data, UTF_8_BOM, 3) == 0)
-                return "UTF-8";
-        }
-        if (size >= 4) {
-            if (memcmp(data, UTF_32_LE_BOM, 4) == 0)
-                return "UTF-32-LE";
-            if (memcmp(data, UTF_32_BE_BOM, 4) == 0)
-                return "UTF-32-BE";
-        }
-        if (size >= 2) {
-            if (memcmp(data, UTF_16_LE_BOM, 2) == 0)
-                return "UTF-16-LE";
-            if (memcmp(data, UTF_16_BE_BOM, 2) == 0)
-                return "UTF-16-BE";
+        if (!extra || !extra->childIndexReady.load(std::memory_order_relaxed)) return;
+        extra->childIndexCount.fetch_sub(1,std::memory_order_relaxed);
+        if (!element) return;
+        const auto it=extra->childIndex.find(element->tag);
+        if (it != extra->childIndex.end())
+        {
+            it->removeOne(const_cast<QDomLiteElement*>(element));
+            if (it->isEmpty()) extra->childIndex.erase(it);
         }
-        return QString();
     }
-    QString decodedByteArray(const QByteArray& a)
+    QDomLiteElement* parentElement=nullptr;
+    QDomLiteElementExtra* extra=nullptr;
+    std::atomic<int> childPosition{-1}; // renumbered by const lookups, which may run on several threads
+    mutable std::atomic<int> firstStalePosition{std::numeric_limits<int>::max()}; // children from here on may have an outdated childPosition
+    friend class QDomLiteElementPool;
+    friend class QDomLiteTreeBuilder;
+};
+
+class QDomLiteElementPool
+{
+public:
+    inline QDomLiteElementPool(const int limit=65536) : limit(limit) {}
+    inline ~QDomLiteElementPool() { clear(); }
+    inline QDomLiteElement* acquire()
     {
-        if (check_bom(a.constData(),4).contains("UTF-16"))
+        if (!freeElements.isEmpty())
         {
-#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-            auto fromUtf16 = QStringEncoder(QStringEncoder::Utf8);
-            return QString(fromUtf16(a));
-#else
-            return QString::fromUtf16(reinterpret_cast<const ushort*>(a.constData()));
-#endif
+            reuseCount++;
+            return freeElements.takeLast();
         }
-        return a;
+        allocationCount++;
+        QDOMLITE_STAT(allocations++);
+        return new QDomLiteElement;
     }
-    inline bool appendEntities(const XMLStringClass& XML, int& Ptr)
+    inline void recycle(QDomLiteElement* element)
     {
-        bool retVal=false;
-        forever
+        if (!element) return;
+        reset(element);
+        if (freeElements.size() < limit)
         {
-            const auto RemarkMatch = rxRemark.matchView(XML, Ptr);
-            if (RemarkMatch.capturedStart() != Ptr) break;
-            Ptr += RemarkMatch.capturedLength(); //skip!
+            freeElements.append(element);
         }
-
-        forever
+        else
         {
-            const auto EntityMatch = rxEntity.matchView(XML, Ptr);
-            if (EntityMatch.capturedStart() != Ptr) break;
-            entities.insert('&' + EntityMatch.captured(1) + ';', EntityMatch.captured(2));
-            Ptr += EntityMatch.capturedLength();
-            retVal=true;
+            delete element;
         }
-        return retVal;
     }
-    inline bool appendComments(const XMLStringClass& XML, int& Ptr)
+    inline void reset(QDomLiteElement* element)
     {
-        bool retVal=false;
-        forever
+        for (const auto e : std::as_const(element->childElements))
         {
-#ifdef QT_DEBUG
-            const auto XMLAttributesMatch = rxXMLAttributes.matchView(XML.sliced(Ptr,qMin(XMLmaxtaglen,XML.length()-Ptr)));
-#else
-            //const auto XMLAttributesMatch = rxXMLAttributes.matchView(XML.sliced(Ptr,qMin(XMLmaxtaglen,XML.length()-Ptr)));
-            const auto XMLAttributesMatch = rxXMLAttributes.matchView(XML.sliced(Ptr,XMLmaxtaglen));
-#endif
-            if (XMLAttributesMatch.capturedStart() != 0) break;
-            appendAttributesString(XMLAttributesMatch.captured(1));
-            Ptr += XMLAttributesMatch.capturedLength();
+            e->parentElement=nullptr;
+            recycle(e);
+        }
+        element->childElements.clear();
+        element->parentElement=nullptr;
+        element->childPosition.store(-1,std::memory_order_relaxed);
+        element->tag.resize(0);
+        element->text.resize(0);
+        element->clearAttributes();
+        delete element->extra;
+        element->extra=nullptr;
+    }
+    inline void clear()
+    {
+        qDeleteAll(freeElements);
+        freeElements.clear();
+    }
+    inline int size() const { return freeElements.size(); }
+    inline void setLimit(const int limit)
+    {
+        this->limit=limit;
+        while (freeElements.size() > limit) delete freeElements.takeLast();
+    }
+    qint64 allocationCount=0;
+    qint64 reuseCount=0;
+private:
+    QDomLiteElementList freeElements;
+    int limit;
+};
+
+class QDomLiteElementPoolScope
+{
+public:
+    inline QDomLiteElementPoolScope(QDomLiteElementPool* pool) : previous(QDomLite::activeElementPool()) { QDomLite::activeElementPool()=pool; }
+    inline ~QDomLiteElementPoolScope() { QDomLite::activeElementPool()=previous; }
+private:
+    QDomLiteElementPool* previous;
+};
+
+class QDomLiteParseOptionsScope
+{
+public:
+    inline QDomLiteParseOptionsScope(const QDomLiteParseOptions* options) : previous(QDomLite::activeParseOptions())
+    {
+        QDomLite::activeParseOptions()=(options && options->flags) ? options : nullptr;
+    }
+    inline ~QDomLiteParseOptionsScope() { QDomLite::activeParseOptions()=previous; }
+private:
+    const QDomLiteParseOptions* previous;
+};
+
+namespace QDomLite
+{
+inline QDomLiteElement* createElement()
+{
+    if (auto pool=activeElementPool()) return pool->acquire();
+    QDOMLITE_STAT(allocations++);
+    return new QDomLiteElement;
+}
+inline void disposeElement(QDomLiteElement* e)
+{
+    if (auto pool=activeElementPool())
+    {
+        pool->recycle(e);
+        return;
+    }
+    delete e;
+}
+}
+
+class QDomLiteProjection
+{
+public:
+    enum Action
+    {
+        Skip=0,
+        Descend=1,
+        Select=2
+    };
+    inline QDomLiteProjection() {}
+    inline QDomLiteProjection(const QStringList& paths) // "config/network/*", one tag or * per level starting at the document element
+    {
+        for (const QString& p : paths) patterns.append(p.split('/',Qt::SkipEmptyParts));
+    }
+    inline QDomLiteProjection(const std::function<bool(const QStringView&)>& tagPredicate) : predicate(tagPredicate) {}
+    inline bool isActive() const { return !patterns.isEmpty() || predicate; }
+    inline Action action(const QStringList& path) const // path holds the tags from the document element down to the element in question
+    {
+        if (predicate) return (predicate(path.last())) ? Select : Descend;
+        const int depth=path.size();
+        Action RetVal=Skip;
+        for (const QStringList& steps : patterns)
+        {
+            if (depth > steps.size()) continue;
+            bool matched=true;
+            for (int i = depth - 1; matched && (i >= 0); i--) matched=stepMatches(steps.at(i),path.at(i));
+            if (!matched) continue;
+            if (depth == steps.size()) return Select;
+            RetVal=Descend;
+        }
+        return RetVal;
+    }
+private:
+    static inline bool stepMatches(const QString& step, const QString& tag) { return (step == QLatin1String("*")) || (step == tag); }
+    QList<QStringList> patterns;
+    std::function<bool(const QStringView&)> predicate;
+};
+
+class QDomLiteTreeBuilder // turns tokens into elements, the push parser, the reader, lazy bodies and QDomLiteElement::fromString all build through it
+{
+public:
+    // Comments before an element or CDATA section go to it, comments after the last child end up in a tagless child.
+    // An element keeps text only while it has no children, the text of mixed content is dropped.
+    inline QDomLiteTreeBuilder(QDomLiteElement* root, const QDomLiteParseOptions* options=nullptr, const QDomLiteProjection& projection=QDomLiteProjection())
+        : root(root), options((options) ? options : &QDomLite::defaultParseOptions), projection(projection) {}
+    inline void reset()
+    {
+        stack.clear();
+        path.clear();
+        actions.clear();
+        deferredAttributes.clear();
+        deferredCount=0;
+        skipDepth=0;
+        pendingComments.clear();
+        pendingText.clear();
+        lazySource.reset();
+        lazyChildEnds.clear();
+        nextChildEnd=0;
+        done=false;
+    }
+    inline void setOptions(const QDomLiteParseOptions* options) { this->options=(options) ? options : &QDomLite::defaultParseOptions; }
+    inline void setProjection(const QDomLiteProjection& projection) { this->projection=projection; }
+    inline void setCDATARoot(const bool accept) { CDATARoot=accept; } // a CDATA section may take the place of the root
+    inline void openRoot(const QSharedPointer<QDomLiteLazySource>& source, const QList<int>& childEnds) // root holds its start tag already and the tokens are its body, its children stay pending on source
+    {
+        stack.append(root);
+        lazySource=source;
+        lazyChildEnds=childEnds;
+        nextChildEnd=0;
+        QDOMLITE_STAT(enter());
+    }
+    inline bool isStarted() const { return !stack.isEmpty() || done; }
+    inline bool isComplete() const { return done; }
+    inline int depth() const { return stack.size(); }
+    inline bool handleToken(QDomLiteTokenizer& t) // false when the token breaks the tree, t moves on only past a pending body
+    {
+        QDOMLITE_STAT_LAP(statTimer,TagMatch);
+        if (skipDepth > 0) // inside an element left out by the projection
+        {
+            if (t.tokenType == QDomLiteTokenizer::StartElement) skipDepth++;
+            else if (t.tokenType == QDomLiteTokenizer::EndElement) skipDepth--;
+            return true;
+        }
+        switch (t.tokenType)
+        {
+        case QDomLiteTokenizer::ProcessingInstruction:
+        case QDomLiteTokenizer::DocType:
+            return true;
+        case QDomLiteTokenizer::Comment:
+            if (done || options->testFlag(QDomLiteParseOptions::SkipComments) || !selecting()) return true;
+            pendingComments.append(QDomLite::valueFromString(t.content.toString()));
+            QDOMLITE_STAT(comments++);
+            QDOMLITE_STAT_LAP(statTimer,CommentScan);
+            return true;
+        case QDomLiteTokenizer::Text:
+            if (!stack.isEmpty() && selecting() && stack.last()->childElements.isEmpty()) pendingText.append(t.content);
+            return true;
+        case QDomLiteTokenizer::CDATA:
+        {
+            if (done) return true;
+            if (stack.isEmpty() && !CDATARoot) return false;
+            if (!selecting()) return true;
+            if (options->testFlag(QDomLiteParseOptions::SkipCDATA))
+            {
+                pendingComments.clear();
+                return true;
+            }
+            auto e=(stack.isEmpty()) ? root : createChild(stack.last());
+            e->setCDATA(t.content.toString());
+            e->setComments(pendingComments);
+            pendingComments.clear();
+            pendingText.clear();
+            if (stack.isEmpty()) done=true;
+            return true;
+        }
+        case QDomLiteTokenizer::StartElement:
+        case QDomLiteTokenizer::EmptyElement:
+        {
+            if (done) return false;
+            const QDomLiteProjection::Action action=startAction(t);
+            if (action != QDomLiteProjection::Select)
+            {
+                pendingComments.clear();
+                pendingText.clear();
+            }
+            if (action == QDomLiteProjection::Skip)
+            {
+                path.removeLast();
+                if (t.tokenType == QDomLiteTokenizer::StartElement) skipDepth=1;
+                return true;
+            }
+            if ((action == QDomLiteProjection::Descend) && !stack.isEmpty()) // built only if a selected element turns up inside
+            {
+                if (t.tokenType == QDomLiteTokenizer::EmptyElement)
+                {
+                    path.removeLast();
+                    return true;
+                }
+                stack.append(nullptr);
+                actions.append(action);
+                deferredAttributes.append((options->skipsAttributes(path.last())) ? QString() : t.content.toString());
+                deferredCount++;
+                return true;
+            }
+            materialize();
+            auto e=(stack.isEmpty()) ? root : createChild(stack.last());
+            QDomLite::assignString(e->tag,t.name);
+            e->setComments(pendingComments);
+            pendingComments.clear();
+            pendingText.clear();
+            QDOMLITE_STAT(elements++);
+            if (!options->skipsAttributes(e->tag)) e->appendAttributesString(t.content.toString());
+            QDOMLITE_STAT_LAP(statTimer,AttributeParse);
+            if (t.tokenType == QDomLiteTokenizer::EmptyElement)
+            {
+                if (projection.isActive()) path.removeLast();
+                if (stack.isEmpty()) done=true;
+                return true;
+            }
+            if (lazySource && (stack.size() == 1)) // the body is parsed when the child is first used
+            {
+                const int bodyStart=t.position;
+                QList<int> childEnds; // only one level, deeper bodies are found again when they are expanded
+                if (nextChildEnd < lazyChildEnds.size()) t.position=lazyChildEnds.at(nextChildEnd++);
+                else if (!QDomLiteLazySource::skipElement(t,childEnds)) return false;
+                e->setPending(lazySource,bodyStart,childEnds);
+                return true;
+            }
+            stack.append(e);
+            QDOMLITE_STAT(enter());
+            if (projection.isActive())
+            {
+                actions.append(action);
+                deferredAttributes.append(QString());
+            }
+            return true;
+        }
+        case QDomLiteTokenizer::EndElement:
+        {
+            if (stack.isEmpty()) return false;
+            auto e=stack.takeLast();
+            if (projection.isActive())
+            {
+                const QString tag=path.takeLast();
+                actions.removeLast();
+                deferredAttributes.removeLast();
+                if (!e) // a deferred element that never got built
+                {
+                    deferredCount--;
+                    pendingText.clear();
+                    pendingComments.clear();
+                    return (t.name.compare(tag) == 0);
+                }
+            }
+            if (t.name.compare(e->tag) != 0) return false;
+            closeElement(e);
+            QDOMLITE_STAT(leave());
+            if (stack.isEmpty()) done=true;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+private:
+    QDomLiteElement* root;
+    const QDomLiteParseOptions* options;
+    QDomLiteProjection projection;
+    QDomLiteElementList stack;
+    QDomLiteValueList pendingComments;
+    QString pendingText;
+    QStringList path;
+    QList<QDomLiteProjection::Action> actions;
+    QStringList deferredAttributes;
+    QSharedPointer<QDomLiteLazySource> lazySource;
+    QList<int> lazyChildEnds;
+    int nextChildEnd=0;
+    int deferredCount=0;
+    int skipDepth=0;
+    bool CDATARoot=false;
+    bool done=false;
+    QDOMLITE_STAT_TIMER(statTimer);
+    inline QDomLiteElement* createChild(QDomLiteElement* parent)
+    {
+        auto e=QDomLite::createElement();
+        QDOMLITE_STAT_LAP(statTimer,Allocation);
+        parent->appendParsed(e);
+        return e;
+    }
+    inline void closeElement(QDomLiteElement* e)
+    {
+        if (e->childElements.isEmpty() && !pendingText.isEmpty() && options->keepsText(pendingText))
+        {
+            e->text.fromEncodedString(pendingText.trimmed());
+            QDOMLITE_STAT(textNodes++);
+            QDOMLITE_STAT_LAP(statTimer,EntityDecode);
+        }
+        if (!pendingComments.isEmpty() && e->text.isEmpty()) createChild(e)->setComments(pendingComments);
+        pendingText.clear();
+        pendingComments.clear();
+        e->invalidateChildIndex();
+    }
+    inline bool selecting() const { return actions.isEmpty() || (actions.last() == QDomLiteProjection::Select); }
+    inline void materialize() // creates the deferred ancestors of a selected element
+    {
+        for (int i = 1; (deferredCount > 0) && (i < stack.size()); i++)
+        {
+            if (stack.at(i)) continue;
+            auto e=createChild(stack.at(i-1));
+            e->tag=path.at(i);
+            e->appendAttributesString(deferredAttributes.at(i));
+            stack[i]=e;
+            deferredCount--;
+        }
+    }
+    inline QDomLiteProjection::Action startAction(const QDomLiteTokenizer& t)
+    {
+        if (!projection.isActive()) return QDomLiteProjection::Select;
+        path.append(t.name.toString());
+        QDomLiteProjection::Action action=(selecting() && !actions.isEmpty()) ? QDomLiteProjection::Select : projection.action(path);
+        if (stack.isEmpty() && (action == QDomLiteProjection::Skip)) action=QDomLiteProjection::Descend; // the document element is always built
+        return action;
+    }
+};
+
+inline int QDomLiteElement::fromString(const XMLStringClass& XML, int start)
+{
+    QDomLiteTreeBuilder builder(this,QDomLite::activeParseOptions());
+    builder.setCDATARoot(true);
+    QDomLiteTokenizer t;
+    t.setData(XML,true,start);
+    while (!builder.isComplete())
+    {
+        const auto type=t.next();
+        if ((type == QDomLiteTokenizer::NoToken) || (type == QDomLiteTokenizer::Invalid) || !builder.handleToken(t)) return start;
+    }
+    return t.position;
+}
+
+inline void QDomLiteElement::expandPending()
+{
+    QSharedPointer<QDomLiteLazySource> source; // keeps the buffer alive while it is parsed
+    {
+        QMutexLocker sourceLocker(&QDomLite::lazySourceMutex());
+        source=extra->lazySource;
+    }
+    if (!source) return; // another thread expanded it meanwhile
+    QMutexLocker locker(&source->mutex);
+    if (!extra->lazyPending.load(std::memory_order_relaxed)) return; // another thread got here first
+    QDomLiteTokenizer t;
+    t.setData(source->XML,true,extra->lazyStart);
+    QDomLiteTreeBuilder builder(this,&source->options);
+    builder.openRoot(source,extra->lazyChildEnds);
+    while (!builder.isComplete())
+    {
+        const auto type=t.next();
+        if ((type == QDomLiteTokenizer::NoToken) || (type == QDomLiteTokenizer::Invalid) || !builder.handleToken(t)) break;
+    }
+    extra->lazyChildEnds.clear();
+    extra->lazyPending.store(false,std::memory_order_release);
+    QMutexLocker sourceLocker(&QDomLite::lazySourceMutex());
+    extra->lazySource.reset();
+}
+
+class QDomLiteCompressedDevice : public QIODevice // streams gzip, zlib or zstd through another device in one direction
+{
+public:
+    enum Format
+    {
+        Uncompressed=0,
+        Gzip=1,
+        Zlib=2,
+        Zstd=3
+    };
+    inline QDomLiteCompressedDevice(QIODevice* device, const Format format, const int level=-1) : device(device), format(format), level(level) {}
+    inline ~QDomLiteCompressedDevice() override { close(); }
+    static inline Format detect(const QByteArray& head)
+    {
+        if (head.size() < 2) return Uncompressed;
+        const uchar b0=uchar(head.at(0));
+        const uchar b1=uchar(head.at(1));
+        if ((b0 == 0x1f) && (b1 == 0x8b)) return Gzip;
+        if (((b0 & 0x0f) == 8) && (((b0 << 8) | b1) % 31 == 0)) return Zlib;
+        if (head.startsWith(QByteArray::fromRawData("\x28\xb5\x2f\xfd",4))) return Zstd;
+        return Uncompressed;
+    }
+    static inline Format formatForPath(const QString& path)
+    {
+        const QString suffix=path.section('.',-1).toLower();
+        if ((suffix == QLatin1String("gz")) || (suffix == QLatin1String("gzip"))) return Gzip;
+        if ((suffix == QLatin1String("zz")) || (suffix == QLatin1String("zlib"))) return Zlib;
+        if ((suffix == QLatin1String("zst")) || (suffix == QLatin1String("zstd"))) return Zstd;
+        return Uncompressed;
+    }
+    static inline Format savingFormat(const QString& path) // plain XML when the codec for the suffix is not built in, as before compression support
+    {
+        const Format format=formatForPath(path);
+        return (isSupported(format)) ? format : Uncompressed;
+    }
+    static inline bool isSupported(const Format format)
+    {
+        switch (format)
+        {
+        case Uncompressed:
+            return true;
+        case Gzip:
+        case Zlib:
+#ifdef QDOMLITE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Zstd:
+#ifdef QDOMLITE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+    inline bool open(OpenMode mode) override
+    {
+        if (isOpen() || !device || (format == Uncompressed) || !isSupported(format)) return false;
+        if (((mode & ReadWrite) == ReadWrite) || (mode & Append)) return false; // one direction at a time
+        writing=((mode & WriteOnly) != 0);
+        ended=false;
+        frameEnded=false;
+        failed=false;
+        input.clear();
+        inputPosition=0;
+        if (!startCodec()) return false;
+        return QIODevice::open(mode | Unbuffered);
+    }
+    inline void close() override
+    {
+        if (!isOpen()) return;
+        if (writing && !failed) flushCodec(true);
+        endCodec();
+        QIODevice::close();
+    }
+    inline bool isSequential() const override { return true; }
+    inline bool atEnd() const override { return !isOpen() || (!writing && ended); }
+    inline bool hasError() const { return failed; }
+protected:
+    inline qint64 readData(char* data, qint64 maxSize) override
+    {
+        if (writing || failed) return -1;
+        qint64 produced=0;
+        while ((produced == 0) && !ended && (maxSize > 0))
+        {
+            if (inputPosition >= input.size())
+            {
+                input=device->read(XMLasyncchunksize);
+                inputPosition=0;
+                if (input.isEmpty())
+                {
+                    if (!device->atEnd()) break; // nothing available yet
+                    if (!frameEnded) // the data ends inside the stream
+                    {
+                        fail();
+                        return -1;
+                    }
+                    ended=true;
+                    break;
+                }
+            }
+            const qint64 n=decode(data+produced,maxSize-produced);
+            if (n < 0)
+            {
+                fail();
+                return -1;
+            }
+            produced+=n;
+        }
+        return produced;
+    }
+    inline qint64 writeData(const char* data, qint64 maxSize) override
+    {
+        if (!writing || failed) return -1;
+        input=QByteArray::fromRawData(data,int(maxSize));
+        inputPosition=0;
+        if (!flushCodec(false)) return -1;
+        input.clear();
+        return maxSize;
+    }
+private:
+    QIODevice* device;
+    Format format;
+    int level;
+    QByteArray input;
+    int inputPosition=0;
+    bool writing=false;
+    bool ended=false;
+    bool frameEnded=false; // the last zstd frame read is complete, more frames may follow
+    bool failed=false;
+#ifdef QDOMLITE_ZLIB
+    z_stream zs;
+#endif
+#ifdef QDOMLITE_ZSTD
+    ZSTD_CCtx* zstdCompressor=nullptr;
+    ZSTD_DCtx* zstdDecompressor=nullptr;
+#endif
+    inline void fail()
+    {
+        failed=true;
+        setErrorString(QStringLiteral("Corrupt or unsupported compressed data"));
+    }
+    inline bool startCodec()
+    {
+#ifdef QDOMLITE_ZLIB
+        if (format != Zstd)
+        {
+            zs=z_stream();
+            const int windowBits=(format == Gzip) ? 15+16 : 15;
+            return (writing) ? (deflateInit2(&zs,(level < 0) ? Z_DEFAULT_COMPRESSION : level,Z_DEFLATED,windowBits,8,Z_DEFAULT_STRATEGY) == Z_OK)
+                             : (inflateInit2(&zs,windowBits) == Z_OK);
+        }
+#endif
+#ifdef QDOMLITE_ZSTD
+        if (format == Zstd)
+        {
+            if (!writing) return (zstdDecompressor=ZSTD_createDCtx()) != nullptr;
+            zstdCompressor=ZSTD_createCCtx();
+            if (zstdCompressor && (level >= 0)) ZSTD_CCtx_setParameter(zstdCompressor,ZSTD_c_compressionLevel,level);
+            return zstdCompressor != nullptr;
+        }
+#endif
+        return false;
+    }
+    inline void endCodec()
+    {
+#ifdef QDOMLITE_ZLIB
+        if (format != Zstd) (writing) ? deflateEnd(&zs) : inflateEnd(&zs);
+#endif
+#ifdef QDOMLITE_ZSTD
+        ZSTD_freeCCtx(zstdCompressor);
+        ZSTD_freeDCtx(zstdDecompressor);
+        zstdCompressor=nullptr;
+        zstdDecompressor=nullptr;
+#endif
+    }
+    inline qint64 decode(char* data, const qint64 maxSize) // consumes input, returns the bytes produced or -1
+    {
+#ifdef QDOMLITE_ZLIB
+        if (format != Zstd)
+        {
+            zs.next_in=reinterpret_cast<Bytef*>(const_cast<char*>(input.constData()+inputPosition));
+            zs.avail_in=uInt(input.size()-inputPosition);
+            zs.next_out=reinterpret_cast<Bytef*>(data);
+            zs.avail_out=uInt(qMin<qint64>(maxSize,std::numeric_limits<uInt>::max()));
+            const int r=inflate(&zs,Z_NO_FLUSH);
+            const qint64 produced=qint64(reinterpret_cast<char*>(zs.next_out)-data);
+            inputPosition=input.size()-int(zs.avail_in);
+            if (r == Z_STREAM_END) ended=true;
+            else if ((r != Z_OK) && (r != Z_BUF_ERROR)) return -1;
+            return produced;
+        }
+#endif
+#ifdef QDOMLITE_ZSTD
+        if (format == Zstd)
+        {
+            ZSTD_inBuffer in={input.constData(),size_t(input.size()),size_t(inputPosition)};
+            ZSTD_outBuffer out={data,size_t(maxSize),0};
+            const size_t r=ZSTD_decompressStream(zstdDecompressor,&out,&in);
+            if (ZSTD_isError(r)) return -1;
+            inputPosition=int(in.pos);
+            frameEnded=(r == 0);
+            if (frameEnded && (in.pos == in.size) && device->atEnd()) ended=true; // last frame complete
+            return qint64(out.pos);
+        }
+#endif
+        Q_UNUSED(data)
+        Q_UNUSED(maxSize)
+        return -1;
+    }
+    inline bool flushCodec(const bool finish) // compresses the pending input, and the stream end when finishing
+    {
+        char buffer[16384];
+#ifdef QDOMLITE_ZLIB
+        if (format != Zstd)
+        {
+            zs.next_in=reinterpret_cast<Bytef*>(const_cast<char*>(input.constData()+inputPosition));
+            zs.avail_in=uInt(input.size()-inputPosition);
+            forever
+            {
+                zs.next_out=reinterpret_cast<Bytef*>(buffer);
+                zs.avail_out=sizeof(buffer);
+                const int r=deflate(&zs,(finish) ? Z_FINISH : Z_NO_FLUSH);
+                if (r == Z_STREAM_ERROR)
+                {
+                    fail();
+                    return false;
+                }
+                const qint64 n=qint64(sizeof(buffer)-zs.avail_out);
+                if ((n > 0) && (device->write(buffer,n) != n))
+                {
+                    fail();
+                    return false;
+                }
+                if (finish ? (r == Z_STREAM_END) : (zs.avail_out != 0)) return true;
+            }
+        }
+#endif
+#ifdef QDOMLITE_ZSTD
+        if (format == Zstd)
+        {
+            ZSTD_inBuffer in={input.constData(),size_t(input.size()),size_t(inputPosition)};
+            forever
+            {
+                ZSTD_outBuffer out={buffer,sizeof(buffer),0};
+                const size_t r=ZSTD_compressStream2(zstdCompressor,&out,&in,(finish) ? ZSTD_e_end : ZSTD_e_continue);
+                if (ZSTD_isError(r))
+                {
+                    fail();
+                    return false;
+                }
+                if ((out.pos > 0) && (device->write(buffer,qint64(out.pos)) != qint64(out.pos)))
+                {
+                    fail();
+                    return false;
+                }
+                if (finish ? (r == 0) : (in.pos == in.size)) return true;
+            }
+        }
+#endif
+        Q_UNUSED(buffer)
+        Q_UNUSED(finish)
+        return false;
+    }
+};
+
+class QDomLiteDocument : public QDomLiteAttributes
+{
+public:
+    inline QDomLiteDocument(const QString& docType, const QString& docTag)
+    {
+        this->docType=docType;
+        documentElement=new QDomLiteElement(docTag);
+    }
+    inline QDomLiteDocument(const QString& path) {
+        documentElement=new QDomLiteElement;
+        load(path);
+    }
+    inline QDomLiteDocument(const QDomLiteDocument* other) {
+        documentElement=new QDomLiteElement;
+        copy(other);
+    }
+    inline QDomLiteDocument(const QString& path,const QString& defaultType, const QString& defaultTag) {
+        docType=defaultType;
+        documentElement=new QDomLiteElement(defaultTag);
+        if (QFileInfo::exists(path)) load(path);
+    }
+    inline QDomLiteDocument(QIODevice& file) {
+        documentElement=new QDomLiteElement;
+        fromFile(file);
+    }
+    inline QDomLiteDocument(QByteArray& byteArray) {
+        documentElement=new QDomLiteElement;
+        fromByteArray(byteArray);
+    }
+    inline QDomLiteDocument() { documentElement=new QDomLiteElement; }
+    inline QDomLiteDocument(const QDomLiteDocument& other) {
+        documentElement=new QDomLiteElement;
+        copy(&other);
+    }
+    inline QDomLiteDocument(QDomLiteDocument&& other) {
+        documentElement=new QDomLiteElement;
+        swap(other);
+    }
+    inline QDomLiteDocument& operator = (const QDomLiteDocument& other)
+    {
+        if (this != &other) copy(&other);
+        return *this;
+    }
+    inline QDomLiteDocument& operator = (QDomLiteDocument&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+    inline void swap(QDomLiteDocument& other) noexcept
+    {
+        std::swap(documentElement,other.documentElement);
+        docType.swap(other.docType);
+        comments.swap(other.comments);
+        entities.swap(other.entities);
+        attributes.swap(other.attributes);
+    }
+    inline ~QDomLiteDocument()
+    {
+        delete documentElement;
+        if (ownsElementPool) delete elementPool;
+    }
+    inline bool fromFile(QIODevice& file) {
+        if (file.isOpen()) return fromDevice(file);
+        if (file.open(QIODevice::ReadOnly))
+        {
+            const bool RetVal=fromDevice(file);
+            file.close();
+            return RetVal;
+        }
+        return false;
+    }
+    inline bool fromDevice(QIODevice& device) // compressed data is detected and parsed chunk by chunk
+    {
+        const auto format=QDomLiteCompressedDevice::detect(device.peek(4));
+        if (format != QDomLiteCompressedDevice::Uncompressed) return fromCompressed(device,format);
+        return fromByteArray(device.readAll());
+    }
+    inline bool fromCompressed(QIODevice& device, const QDomLiteCompressedDevice::Format format);
+    inline bool fromByteArray(const QByteArray& byteArray); // decoded as the push parser decodes compressed input
+    QDomLiteElement* documentElement;
+    inline QDomLiteElement* replaceDoc(QDomLiteElement* element)
+    {
+        delete documentElement;
+        documentElement = element;
+        return element;
+    }
+    inline QDomLiteElement* exchangeDoc(QDomLiteElement* element)
+    {
+        QDomLiteElement** t = &documentElement;
+        documentElement = element;
+        return *t;
+    }
+    inline void swapDoc(QDomLiteElement** element)
+    {
+        QDomLite::swapElements(&documentElement,element);
+    }
+    inline bool save(const QString& path, const bool indent = false) const { return save(path,indent,QDomLiteCompressedDevice::savingFormat(path)); }
+    inline bool save(const QString& path, const bool indent, const QDomLiteCompressedDevice::Format format) const
+    {
+        if (!QDomLiteCompressedDevice::isSupported(format)) return false; // before the file is truncated
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) return false;
+        return save(file,indent,format);
+    }
+    inline bool save(QIODevice& device, const bool indent = false, const QDomLiteCompressedDevice::Format format = QDomLiteCompressedDevice::Uncompressed) const;
+    inline QByteArray toByteArray(const bool indent = false)
+    {
+        QByteArray b;
+        QTextStream ts(&b);
+        ts << toString(indent);
+        return b;
+    }
+    inline bool load(const QString& path)
+    {
+        QFile fileData(path);
+        return fromFile(fileData);
+    }
+    inline bool loadLazy(const QString& path)
+    {
+        QFile fileData(path);
+        if (!fileData.open(QIODevice::ReadOnly)) return false;
+        return fromStringLazy(decodedByteArray(fileData.readAll()));
+    }
+    inline bool load(const QString& path, const QDomLiteProjection& projection); // read and parsed in chunks, only the projection is kept
+#ifdef QDOMLITE_ASYNC
+    // The document must stay alive and untouched until the returned future has finished.
+    inline QFuture<bool> loadAsync(const QString& path, const int chunkSize = XMLasyncchunksize);
+    inline QFuture<bool> saveAsync(const QString& path, const bool indent = false, const int chunkSize = XMLasyncchunksize) const;
+#endif
+    inline void clear()
+    {
+        docType.clear();
+        comments.clear();
+        entities.clear();
+        (elementPool) ? elementPool->reset(documentElement) : documentElement->clear();
+        clearAttributes();
+    }
+    inline void setRecycling(const bool recycle)
+    {
+        if (recycle == (elementPool != nullptr)) return;
+        setElementPool((recycle) ? new QDomLiteElementPool : nullptr);
+        ownsElementPool=recycle;
+    }
+    inline bool isRecycling() const { return (elementPool != nullptr); }
+    inline void setElementPool(QDomLiteElementPool* pool) // a shared pool is not owned and must not be used from several threads at once
+    {
+        if (ownsElementPool) delete elementPool;
+        elementPool=pool;
+        ownsElementPool=false;
+    }
+    inline QDomLiteElementPool* recyclingPool() const { return elementPool; }
+    inline void setParseOptions(const QDomLiteParseOptions& options) { parsingOptions=options; }
+    inline const QDomLiteParseOptions& parseOptions() const { return parsingOptions; }
+    inline void clear(const QString& docType, const QString& docTag)
+    {
+        clear();
+        this->docType=docType;
+        documentElement->tag=docTag;
+    }
+    inline QDomLiteMemoryUsage memoryUsage() const
+    {
+        QDomLiteMemoryUsage usage;
+        QSet<const void*> seen;
+        usage.nodes+=sizeof(QDomLiteDocument);
+        usage.strings+=QDomLite::stringMemory(docType,seen)+QDomLite::valueListMemory(comments,seen);
+        usage.containers+=QDomLite::listMemory(comments);
+        for (auto it = entities.constKeyValueBegin(); it != entities.constKeyValueEnd(); it++)
+        {
+            usage.containers+=qint64(sizeof(QString)) * 2 + qint64(sizeof(void*)) * 4; // map node, approximate
+            usage.strings+=QDomLite::stringMemory(it->first,seen)+QDomLite::stringMemory(it->second,seen);
+        }
+        attributesMemoryUsage(usage,seen);
+        documentElement->memoryUsage(usage,seen);
+        return usage;
+    }
+    inline void compact()
+    {
+        QDomLiteStringPool pool;
+        QDomLite::internString(pool,docType);
+        QDomLite::compactValueList(pool,comments);
+        compactAttributes(pool);
+        documentElement->compact(pool);
+    }
+    inline bool fromString(const XMLStringClass& XML); // false when the XML is not well formed, the tree holds what was built up to there
+    inline bool fromString(const XMLStringClass& XML, const QDomLiteProjection& projection);
+    inline bool fromStringLazy(const QString& XML) // element bodies are parsed on first access
+    {
+        clear();
+        const auto source=QSharedPointer<QDomLiteLazySource>::create(XML,parsingOptions);
+        QDomLiteTokenizer t(source->XML);
+        forever
+        {
+            switch (t.next())
+            {
+            case QDomLiteTokenizer::ProcessingInstruction:
+                if (t.name.compare(QLatin1String("xml"),Qt::CaseInsensitive) == 0) appendAttributesString(t.content.toString());
+                break;
+            case QDomLiteTokenizer::DocType:
+                docTypeFromString(t.raw().toString());
+                break;
+            case QDomLiteTokenizer::Comment:
+                if (!parsingOptions.testFlag(QDomLiteParseOptions::SkipComments)) comments.append(QDomLite::valueFromString(t.content.toString()));
+                break;
+            case QDomLiteTokenizer::Text:
+                break;
+            case QDomLiteTokenizer::StartElement:
+            case QDomLiteTokenizer::EmptyElement:
+                QDomLite::assignString(documentElement->tag,t.name);
+                if (!parsingOptions.skipsAttributes(documentElement->tag)) documentElement->appendAttributesString(t.content.toString());
+                if (t.tokenType == QDomLiteTokenizer::StartElement) documentElement->setPending(source,t.position);
+                return true;
+            default:
+                return false;
+            }
+        }
+    }
+    inline int docTypeFromString(const XMLStringClass& XML, int Ptr=0)
+    {
+        const auto DocTypeMatch = rxdocType.matchView(XML, Ptr);
+        if (DocTypeMatch.capturedStart() == Ptr)
+        {
+            docType=DocTypeMatch.captured(1).trimmed();
+            Ptr+=DocTypeMatch.capturedLength();
+            const auto EntityMatch = rxEntityTags.matchView(XML, Ptr - 1);
+            if (EntityMatch.capturedStart() == Ptr - 1)
+            {
+                if (!parsingOptions.testFlag(QDomLiteParseOptions::SkipEntities))
+                {
+                    const QString ent(EntityMatch.captured(1));
+                    int eptr = 0;
+                    while (appendEntities(ent, eptr)){}
+                }
+                Ptr+=EntityMatch.capturedLength();
+            }
+        }
+        return Ptr;
+    }
+    inline QDomLiteDocument* clone() const { return new QDomLiteDocument(this); }
+    inline void copy(const QDomLiteDocument* other)
+    {
+        clear();
+        docType=other->docType;
+        comments=other->comments;
+        entities=other->entities;
+        attributes.append(other->attributes);
+        replaceDoc(other->documentElement->clone());
+    }
+    inline const QString toString(const bool indent=false) const
+    {
+#ifdef QDOMLITE_STATISTICS
+        const QDomLiteStatisticsScope statisticsScope(serializeStatistics,QDomLiteStatistics::Serialize,statisticsCallback);
+#endif
+        const QString RetVal = headerString() + documentElement->toString(-(!indent));
+        QDOMLITE_STAT(charactersProduced=RetVal.size());
+        return RetVal;
+    }
+#ifdef QDOMLITE_STATISTICS
+    QDomLiteStatistics parseStatistics;
+    mutable QDomLiteStatistics serializeStatistics;
+    QDomLiteStatisticsCallback statisticsCallback;
+#endif
+private:
+    friend class QDomLiteWriter;
+    inline const QString headerString() const
+    {
+        QString RetVal = (!attributes.isEmpty()) ? QStringLiteral("<?xml") + attributesString() + QStringLiteral("?>\n") :
+                                                   QStringLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+        if (!docType.isEmpty())
+        {
+            RetVal += QStringLiteral("<!DOCTYPE ")+docType;
+            if (!entities.isEmpty())
+            {
+                RetVal+=QStringLiteral(" [\n");
+                for (auto it = entities.constKeyValueBegin(); it != entities.constKeyValueEnd(); it++)
+                {
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+                    RetVal+=QStringLiteral("<!ENTITY ")+it->first.midRef(1,it->first.size()-2)+QStringLiteral(" \"")+it->second+QStringLiteral("\">\n");
+#else
+                    RetVal+=QStringLiteral("<!ENTITY ")+it->first.mid(1,it->first.size()-2)+QStringLiteral(" \"")+it->second+QStringLiteral("\">\n");
+#endif
+                }
+                RetVal+=QStringLiteral("] ");
+            }
+            RetVal+=QStringLiteral(">\n");
+        }
+        for (const QDomLiteValue& c : comments) RetVal += QStringLiteral("<!--")+c.encodedString()+QStringLiteral("-->\n");
+        return RetVal;
+    }
+public:
+    inline const QString decodeEntities(QDomLiteElement* textElement) const
+    {
+        textElement->expand();
+        return decodeEntities(textElement->text);
+    }
+    inline const QString decodeEntities(const QString& text) const
+    {
+        if (entities.isEmpty()) return text;
+        QString retVal(text);
+        for (auto it = entities.constKeyValueBegin(); it != entities.constKeyValueEnd(); it++) retVal.replace(it->first,it->second);
+        return retVal;
+    }
+    inline void addEntity(const QString& entity, const QString& value)
+    {
+        QString e = entity;
+        if (!e.startsWith('&')) e = '&' + e;
+        if (!e.endsWith(';')) e += ';';
+        entities.insert(e, value);
+    }
+    QString docType;
+    QDomLiteValueList comments;
+    QDomLiteEntityMap entities;
+    inline operator QString() { return toString(true); }
+private:
+    QDomLiteElementPool* elementPool=nullptr;
+    bool ownsElementPool=false;
+    QDomLiteParseOptions parsingOptions;
+    const char *UTF_16_BE_BOM = "\xFE\xFF";
+    const char *UTF_16_LE_BOM = "\xFF\xFE";
+    const char *UTF_8_BOM = "\xEF\xBB\xBF";
+    const char *UTF_32_BE_BOM = "\x00\x00\xFE\xFF";
+    const char *UTF_32_LE_BOM = "\xFF\xFE\x00\x00";
+    QString check_bom(const char *data, size_t size)
+    {
+        if (size >= 3) {
+            if (memcmp(data, UTF_8_BOM, 3) == 0)
+                return "UTF-8";
+        }
+        if (size >= 4) {
+            if (memcmp(data, UTF_32_LE_BOM, 4) == 0)
+                return "UTF-32-LE";
+            if (memcmp(data, UTF_32_BE_BOM, 4) == 0)
+                return "UTF-32-BE";
+        }
+        if (size >= 2) {
+            if (memcmp(data, UTF_16_LE_BOM, 2) == 0)
+                return "UTF-16-LE";
+            if (memcmp(data, UTF_16_BE_BOM, 2) == 0)
+                return "UTF-16-BE";
+        }
+        return QString();
+    }
+    QString decodedByteArray(const QByteArray& a)
+    {
+        if (check_bom(a.constData(),4).contains("UTF-16"))
+        {
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+            auto fromUtf16 = QStringEncoder(QStringEncoder::Utf8);
+            return QString(fromUtf16(a));
+#else
+            return QString::fromUtf16(reinterpret_cast<const ushort*>(a.constData()));
+#endif
+        }
+        return a;
+    }
+    inline bool appendEntities(const XMLStringClass& XML, int& Ptr)
+    {
+        bool retVal=false;
+        forever
+        {
+            const auto RemarkMatch = rxRemark.matchView(XML, Ptr);
+            if (RemarkMatch.capturedStart() != Ptr) break;
+            Ptr += RemarkMatch.capturedLength(); //skip!
+        }
+
+        forever
+        {
+            const auto EntityMatch = rxEntity.matchView(XML, Ptr);
+            if (EntityMatch.capturedStart() != Ptr) break;
+            entities.insert('&' + EntityMatch.captured(1) + ';', EntityMatch.captured(2));
+            Ptr += EntityMatch.capturedLength();
             retVal=true;
         }
-        forever
+        return retVal;
+    }
+};
+
+class QDomLiteWriter
+{
+public:
+    inline QDomLiteWriter(QIODevice* device, const bool indent=false, const int bufferSize=XMLwriterbuffersize)
+        : device(device), indenting(indent), bufferSize(bufferSize)
+    {
+        buffer.reserve(bufferSize+XMLmaxtaglen);
+    }
+    inline ~QDomLiteWriter() { flush(); }
+    inline void setFlushCallback(const std::function<bool()>& callback) { flushCallback=callback; } // called after each chunk is written, returning false stops the writer
+    inline void writeStartDocument() { buffer+=QStringLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"); }
+    inline void writeStartDocument(const QDomLiteDocument& document) { buffer+=document.headerString(); }
+    inline void writeDocument(const QDomLiteDocument& document)
+    {
+        writeStartDocument(document);
+        writeElement(document.documentElement);
+        flush();
+    }
+    inline void startElement(const QString& name)
+    {
+        elements++;
+        closeStartTag(true);
+        writeIndent();
+        buffer+='<';
+        buffer+=name;
+        tags.append(name);
+        startOpen=true;
+        hasText=false;
+    }
+    inline void attribute(const QString& name, const QDomLiteValue& value) // only valid directly after startElement
+    {
+        if (!startOpen) return;
+        buffer+=QChar::Space;
+        buffer+=name;
+        buffer+=QStringLiteral("=\"");
+        value.appendEncodedString(buffer);
+        buffer+='"';
+    }
+    inline void text(const QDomLiteValue& value)
+    {
+        closeStartTag(false);
+        value.appendEncodedString(buffer);
+        hasText=true;
+        checkFlush();
+    }
+    inline void comment(const QDomLiteValue& value)
+    {
+        closeStartTag(true);
+        writeIndent();
+        buffer+=QStringLiteral("<!--");
+        value.appendEncodedString(buffer);
+        buffer+=QStringLiteral("-->\n");
+        checkFlush();
+    }
+    inline void CDATA(const QString& value)
+    {
+        closeStartTag(true);
+        writeIndent();
+        buffer+=QStringLiteral("<![CDATA[");
+        buffer+=value;
+        buffer+=QStringLiteral("]]>\n");
+        checkFlush();
+    }
+    inline void endElement()
+    {
+        if (tags.isEmpty()) return;
+        const QString tag=tags.takeLast();
+        if (startOpen)
+        {
+            buffer+=QStringLiteral("/>\n");
+        }
+        else
+        {
+            if (!hasText) writeIndent();
+            buffer+=QStringLiteral("</");
+            buffer+=tag;
+            buffer+=QStringLiteral(">\n");
+        }
+        startOpen=false;
+        hasText=false;
+        checkFlush();
+    }
+    inline void writeElement(const QDomLiteElement* element) // same layout as QDomLiteElement::toString
+    {
+        if (failed) return;
+        element->expand();
+        if (element->isCDATA()) return CDATA(element->CDATA());
+        for (const QDomLiteValue& c : element->comments()) comment(c);
+        if (element->tag.isEmpty()) return; // the comments after the last child of its parent
+        startElement(element->tag);
+        for (const auto a : element->attributes) attribute(a->name,a->value);
+        if (!element->text.isEmpty())
+        {
+            text(element->text);
+        }
+        else
+        {
+            for (const auto e : element->childElements) writeElement(e);
+        }
+        endElement();
+    }
+    inline void endDocument()
+    {
+        while (!tags.isEmpty()) endElement();
+        flush();
+    }
+    inline bool flush()
+    {
+        if (failed) return false;
+        if (!buffer.isEmpty())
+        {
+            const QByteArray data=buffer.toUtf8();
+            if (device->write(data) != data.size()) failed=true;
+            buffer.resize(0); // keeps the capacity for the next chunk
+            if (!failed && flushCallback && !flushCallback()) failed=true;
+        }
+        return !failed;
+    }
+    inline int depth() const { return tags.size(); }
+    inline int elementsWritten() const { return elements; }
+    inline bool hasError() const { return failed; }
+private:
+    inline void closeStartTag(const bool newLine)
+    {
+        if (!startOpen) return;
+        buffer+=(newLine) ? QStringLiteral(">\n") : QStringLiteral(">");
+        startOpen=false;
+    }
+    inline void writeIndent()
+    {
+        if (indenting) buffer+=QString(tags.size(),QChar::Tabulation);
+    }
+    inline void checkFlush()
+    {
+        if (buffer.size() >= bufferSize) flush();
+    }
+    QIODevice* device;
+    bool indenting;
+    int bufferSize;
+    QString buffer;
+    QStringList tags;
+    std::function<bool()> flushCallback;
+    int elements=0;
+    bool startOpen=false;
+    bool hasText=false;
+    bool failed=false;
+};
+
+inline bool QDomLiteDocument::save(QIODevice& device, const bool indent, const QDomLiteCompressedDevice::Format format) const
+{
+    if (format == QDomLiteCompressedDevice::Uncompressed)
+    {
+        QDomLiteWriter writer(&device,indent);
+        writer.writeDocument(*this);
+        return !writer.hasError();
+    }
+    QDomLiteCompressedDevice target(&device,format);
+    if (!target.open(QIODevice::WriteOnly)) return false;
+    QDomLiteWriter writer(&target,indent);
+    writer.writeDocument(*this);
+    target.close();
+    return !writer.hasError() && !target.hasError();
+}
+
+class QDomLitePushParser
+{
+public:
+    inline QDomLitePushParser(QDomLiteDocument* document, const QDomLiteProjection& projection=QDomLiteProjection())
+        : document(document), builder(document->documentElement,&document->parseOptions(),projection) { reset(); }
+    inline void reset()
+    {
+        document->clear();
+        head.clear();
+        buffer.clear();
+        builder.reset();
+        scanned=QDomLiteTokenizer::ScanState();
+        decoderReady=false;
+        failed=false;
+        finished=false;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    inline bool feed(QByteArrayView bytes)
+#else
+    inline bool feed(const QByteArray& bytes)
+#endif
+    {
+        if (failed || finished) return false;
+        if (!decoderReady)
+        {
+            head.append(bytes.data(),bytes.size());
+            if (head.size() < 4) return true;
+            createDecoder();
+            const QByteArray h=head;
+            head.clear();
+            return appendDecoded(h);
+        }
+        return appendDecoded(bytes);
+    }
+    inline bool feed(QIODevice& device) { return feed(device.readAll()); }
+    inline bool feedString(const QStringView& XML)
+    {
+        if (failed || finished) return false;
+        buffer.append(XML);
+        return parseBuffer(false);
+    }
+    inline bool parse(const QStringView& XML) // a complete document, parsed in place without buffering
+    {
+        if (failed || finished) return false;
+        QDomLiteTokenizer t(XML);
+        parseTokens(t);
+        finished=true;
+        return !failed && builder.isComplete();
+    }
+    inline void setProjection(const QDomLiteProjection& projection) { builder.setProjection(projection); }
+    inline bool finish()
+    {
+        if (finished) return !failed && builder.isComplete();
+        if (!failed && !decoderReady && !head.isEmpty())
+        {
+            createDecoder();
+            const QByteArray h=head;
+            head.clear();
+            appendDecoded(h);
+        }
+        if (!failed) parseBuffer(true);
+        finished=true;
+        buffer.clear();
+        return !failed && builder.isComplete();
+    }
+    inline bool hasError() const { return failed; }
+    inline bool isFinished() const { return finished; }
+    inline bool isRootComplete() const { return builder.isComplete(); }
+    inline int depth() const { return builder.depth(); }
+    inline int bufferedSize() const { return buffer.size(); }
+private:
+    QDomLiteDocument* document;
+    QByteArray head;
+    QString buffer;
+    QDomLiteTokenizer::ScanState scanned; // the incomplete token at the start of buffer
+    QDomLiteTreeBuilder builder;
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    QStringDecoder decoder;
+#else
+    QScopedPointer<QTextDecoder> decoder;
+#endif
+    bool decoderReady=false;
+    bool failed=false;
+    bool finished=false;
+    inline void createDecoder()
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+        decoder=QStringDecoder(QStringConverter::encodingForData(head,u'<').value_or(QStringConverter::Utf8));
+#else
+        decoder.reset(QTextCodec::codecForUtfText(head,QTextCodec::codecForName("UTF-8"))->makeDecoder());
+#endif
+        decoderReady=true;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    inline bool appendDecoded(QByteArrayView bytes)
+    {
+        buffer.append(QString(decoder.decode(bytes)));
+        return parseBuffer(false);
+    }
+#else
+    inline bool appendDecoded(const QByteArray& bytes)
+    {
+        buffer.append(decoder->toUnicode(bytes));
+        return parseBuffer(false);
+    }
+#endif
+    inline bool parseBuffer(const bool isFinal)
+    {
+        QDomLiteTokenizer t(buffer,isFinal);
+        t.scanned=scanned;
+        parseTokens(t);
+        buffer.remove(0,t.tokenStart); // keep only the unparsed tail
+        scanned=(t.tokenType == QDomLiteTokenizer::Incomplete) ? t.scanned : QDomLiteTokenizer::ScanState();
+        if (scanned.start >= 0)
+        {
+            scanned.start-=t.tokenStart;
+            scanned.end-=t.tokenStart;
+        }
+        return !failed;
+    }
+    inline void parseTokens(QDomLiteTokenizer& t)
+    {
+        const QDomLiteElementPoolScope poolScope(document->recyclingPool());
+        forever
+        {
+            const auto type=t.next();
+            if ((type == QDomLiteTokenizer::NoToken) || (type == QDomLiteTokenizer::Incomplete)) break;
+            if ((type == QDomLiteTokenizer::Invalid) || !handleToken(t))
+            {
+                failed=true;
+                break;
+            }
+        }
+    }
+    inline bool handleToken(QDomLiteTokenizer& t)
+    {
+        if (!builder.isStarted()) // the prolog belongs to the document
+        {
+            switch (t.tokenType)
+            {
+            case QDomLiteTokenizer::ProcessingInstruction:
+                if (t.name.compare(QLatin1String("xml"),Qt::CaseInsensitive) == 0) document->appendAttributesString(t.content.toString());
+                return true;
+            case QDomLiteTokenizer::DocType:
+                document->docTypeFromString(t.raw().toString());
+                return true;
+            case QDomLiteTokenizer::Comment:
+                if (!document->parseOptions().testFlag(QDomLiteParseOptions::SkipComments)) document->comments.append(QDomLite::valueFromString(t.content.toString()));
+                return true;
+            default:
+                break;
+            }
+        }
+        return builder.handleToken(t);
+    }
+};
+
+class QDomLiteReader
+{
+public:
+    enum EventType
+    {
+        NoEvent=0,
+        StartElement=1,
+        EndElement=2,
+        Text=3,
+        CDATA=4,
+        Comment=5,
+        Invalid=6
+    };
+    inline QDomLiteReader(const QStringView& XML) { tokenizer.setData(XML); }
+    inline QDomLiteReader(const QString& XML) : source(XML) { tokenizer.setData(source); } // keeps the string alive for the views
+    inline EventType next()
+    {
+        if (currentEvent == Invalid) return currentEvent;
+        if (pendingEnd) // the second half of an empty element
+        {
+            pendingEnd=false;
+            tags.removeLast();
+            return currentEvent=EndElement;
+        }
+        forever
+        {
+            switch (tokenizer.next())
+            {
+            case QDomLiteTokenizer::NoToken:
+                finished=true;
+                return currentEvent=(tags.isEmpty()) ? NoEvent : Invalid;
+            case QDomLiteTokenizer::StartElement:
+            case QDomLiteTokenizer::EmptyElement:
+                tags.append(tokenizer.name);
+                pendingEnd=(tokenizer.tokenType == QDomLiteTokenizer::EmptyElement);
+                attributePosition=0;
+                return currentEvent=StartElement;
+            case QDomLiteTokenizer::EndElement:
+                if (tags.isEmpty() || (tags.last() != tokenizer.name)) return currentEvent=Invalid;
+                tags.removeLast();
+                return currentEvent=EndElement;
+            case QDomLiteTokenizer::Text:
+                if (tokenizer.content.trimmed().isEmpty()) break; // indentation between tags
+                return currentEvent=Text;
+            case QDomLiteTokenizer::CDATA:
+                return currentEvent=CDATA;
+            case QDomLiteTokenizer::Comment:
+                return currentEvent=Comment;
+            case QDomLiteTokenizer::ProcessingInstruction:
+            case QDomLiteTokenizer::DocType:
+                break;
+            default:
+                return currentEvent=Invalid;
+            }
+        }
+    }
+    inline EventType readNextStartElement() // the next start element at this level or below, NoEvent at the end of the current element
+    {
+        const int level=depth();
+        forever
+        {
+            switch (next())
+            {
+            case StartElement:
+                return currentEvent;
+            case EndElement:
+                if (depth() < level) return NoEvent;
+                break;
+            case NoEvent:
+            case Invalid:
+                return currentEvent;
+            default:
+                break;
+            }
+        }
+    }
+    inline EventType eventType() const { return currentEvent; }
+    inline bool atEnd() const { return finished || (currentEvent == Invalid); }
+    inline bool hasError() const { return (currentEvent == Invalid); }
+    inline int depth() const { return tags.size(); }
+    inline int position() const { return tokenizer.tokenStart; }
+    inline const QStringView name() const // the element of a start or end event, the enclosing element otherwise
+    {
+        if ((currentEvent == StartElement) || (currentEvent == EndElement)) return tokenizer.name;
+        return (tags.isEmpty()) ? QStringView() : tags.last();
+    }
+    inline bool isEmptyElement() const { return pendingEnd; }
+    inline const QStringView rawText() const { return tokenizer.content; } // text, CDATA or comment as it is in the source
+    inline const QDomLiteValue text() const
+    {
+        if (currentEvent == CDATA) return tokenizer.content.toString();
+        return QDomLite::valueFromString(tokenizer.content.trimmed().toString());
+    }
+    inline const QStringView attributesView() const { return (currentEvent == StartElement) ? tokenizer.content : QStringView(); }
+    inline bool nextAttribute(QStringView& attributeName, QStringView& attributeValue) // raw values, in document order
+    {
+        return QDomLiteTokenizer::nextAttribute(attributesView(),attributePosition,attributeName,attributeValue);
+    }
+    inline bool attributeView(const QStringView& attributeName, QStringView& attributeValue) const
+    {
+        const QStringView s=attributesView();
+        int pos=0;
+        QStringView n;
+        QStringView v;
+        while (QDomLiteTokenizer::nextAttribute(s,pos,n,v))
+        {
+            if (n != attributeName) continue;
+            attributeValue=v;
+            return true;
+        }
+        return false;
+    }
+    inline bool hasAttribute(const QStringView& attributeName) const
+    {
+        QStringView v;
+        return attributeView(attributeName,v);
+    }
+    inline const QDomLiteValue attribute(const QStringView& attributeName, const QString& defaultValue=QString()) const
+    {
+        QStringView v;
+        if (!attributeView(attributeName,v)) return defaultValue;
+        return QDomLite::valueFromString(v.toString());
+    }
+    inline bool skipCurrentElement()
+    {
+        if (currentEvent != StartElement) return false;
+        const bool RetVal=tokenizer.skipElement();
+        tags.removeLast();
+        pendingEnd=false;
+        currentEvent=(RetVal) ? EndElement : Invalid;
+        return RetVal;
+    }
+    inline QDomLiteElement* readElement(const QDomLiteParseOptions* options=nullptr) // builds the current element and its subtree as QDomLiteDocument does, the reader continues after its end tag
+    {
+        if (currentEvent != StartElement) return nullptr;
+        QDomLiteElement* RetVal=new QDomLiteElement;
+        QDomLiteTreeBuilder builder(RetVal,options);
+        bool built=builder.handleToken(tokenizer);
+        while (built && !builder.isComplete())
+        {
+            const auto type=tokenizer.next();
+            built=(type != QDomLiteTokenizer::NoToken) && (type != QDomLiteTokenizer::Invalid) && builder.handleToken(tokenizer);
+        }
+        tags.removeLast();
+        pendingEnd=false;
+        currentEvent=(built) ? EndElement : Invalid;
+        if (built) return RetVal;
+        delete RetVal;
+        return nullptr;
+    }
+private:
+    QString source;
+    QDomLiteTokenizer tokenizer;
+    QList<QStringView> tags;
+    EventType currentEvent=NoEvent;
+    int attributePosition=0;
+    bool pendingEnd=false;
+    bool finished=false;
+};
+
+struct QDomLiteValidationResult
+{
+    inline bool isValid() const { return error.isEmpty(); }
+    inline operator bool() const { return isValid(); }
+    QString error;
+    qint64 offset=-1; // bytes for QByteArray and QIODevice input, characters for string input
+    int line=0;
+    int column=0;
+};
+
+class QDomLiteValidator // well-formedness check on the tokenizer, no nodes are built
+{
+public:
+    static inline QDomLiteValidationResult validate(const QStringView& XML)
+    {
+        QDomLiteValidator v;
+        QDomLiteTokenizer t(XML);
+        if (v.scan(t)) v.finish(t);
+        return v.result(XML,false);
+    }
+    static inline QDomLiteValidationResult validate(const QByteArray& XML)
+    {
+        QDomLiteValidator v;
+        const QString s=v.decode(XML,true);
+        QDomLiteTokenizer t(s);
+        if (v.failedAt < 0 && v.scan(t)) v.finish(t);
+        return v.result(s,true);
+    }
+    static inline QDomLiteValidationResult validate(QIODevice& device, const int chunkSize=XMLasyncchunksize)
+    {
+        if (!device.isOpen() && !device.open(QIODevice::ReadOnly))
+        {
+            QDomLiteValidationResult r;
+            r.error=device.errorString();
+            return r;
+        }
+        QDomLiteValidator v;
+        QString buffer;
+        forever
+        {
+            const QByteArray chunk=device.read(chunkSize);
+            const bool isFinal=chunk.isEmpty();
+            const int decodedStart=int(buffer.size());
+            buffer.append(v.decode(chunk,isFinal));
+            if (v.failedAt > -1)
+            {
+                v.failedAt+=decodedStart;
+                break;
+            }
+            QDomLiteTokenizer t(buffer,isFinal);
+            if (!v.scan(t)) break;
+            if (isFinal)
+            {
+                v.finish(t);
+                break;
+            }
+            v.consume(QStringView(buffer).left(t.tokenStart));
+            buffer.remove(0,t.tokenStart); // only the unfinished token is kept
+        }
+        return v.result(buffer,true);
+    }
+private:
+    QString tagNames; // names of the open elements back to back, they outlive the trimmed input buffer
+    QVarLengthArray<int,64> tags; // start of each open element's name in tagNames
+    QString entityNames;
+    QVarLengthArray<int,16> entities; // start of each declared entity name in entityNames
+    QString message;
+    int failedAt=-1; // position in the current buffer
+    qint64 consumedCharacters=0;
+    qint64 consumedBytes=0;
+    int consumedLines=0;
+    int lastLineLength=0; // characters after the last consumed newline
+    bool rootSeen=false;
+    bool rootClosed=false;
+    bool decoderReady=false;
+    bool utf8=true;
+    bool firstDecode=true;
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    QStringDecoder decoder;
+    QStringConverter::Encoding encoding=QStringConverter::Utf8;
+#else
+    QScopedPointer<QTextDecoder> decoder;
+    QTextCodec* codec=nullptr;
+#endif
+    QByteArray head;
+    QByteArray carry; // bytes of an unfinished sequence the decoder holds back from the previous chunk
+    qint64 decodedBytes=0;
+    inline bool fail(const QString& error, const int position)
+    {
+        message=error;
+        failedAt=position;
+        return false;
+    }
+    inline const QString decode(const QByteArray& bytes, const bool isFinal)
+    {
+        if (!decoderReady)
+        {
+            head.append(bytes);
+            if ((head.size() < 4) && !isFinal) return QString();
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+            encoding=QStringConverter::encodingForData(head,u'<').value_or(QStringConverter::Utf8);
+            utf8=(encoding == QStringConverter::Utf8);
+            decoder=QStringDecoder(encoding);
+#else
+            codec=QTextCodec::codecForUtfText(head,QTextCodec::codecForName("UTF-8"));
+            utf8=(codec->mibEnum() == 106);
+            decoder.reset(codec->makeDecoder());
+#endif
+            decoderReady=true;
+            consumedBytes+=bomLength(head); // the decoder strips it, offsets count it
+            const QByteArray h=head;
+            head.clear();
+            return decode(h,isFinal);
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+        const QString s=decoder.decode(bytes);
+        const bool failure=decoder.hasError();
+#else
+        const QString s=decoder->toUnicode(bytes);
+        const bool failure=decoder->hasFailure();
+#endif
+        if (failure) fail(QStringLiteral("Invalid byte sequence for the document encoding"),failurePosition(carry+bytes));
+        decodedBytes+=bytes.size();
+        const QByteArray tail=carry+bytes.right(3);
+        carry=tail.right((utf8) ? pendingBytes(tail) : int(decodedBytes % 2));
+        firstDecode=false;
+        return s;
+    }
+    static inline int bomLength(const QByteArray& bytes)
+    {
+        if (bytes.startsWith("\xef\xbb\xbf")) return 3;
+        if (bytes.startsWith(QByteArray("\xff\xfe\0\0",4)) || bytes.startsWith(QByteArray("\0\0\xfe\xff",4))) return 4;
+        if (bytes.startsWith("\xff\xfe") || bytes.startsWith("\xfe\xff")) return 2;
+        return 0;
+    }
+    static inline int pendingBytes(const QByteArray& bytes) // length of an unfinished UTF-8 sequence at the end
+    {
+        for (int i = 1; i <= qMin(3,int(bytes.size())); i++)
+        {
+            const uchar c=uchar(bytes.at(bytes.size()-i));
+            if ((c & 0xc0) == 0x80) continue;
+            const int length=(c >= 0xf0) ? 4 : (c >= 0xe0) ? 3 : (c >= 0xc0) ? 2 : 1;
+            return (length > i) ? i : 0;
+        }
+        return 0;
+    }
+    inline int replay(const QByteArray& bytes, bool& failure) const // characters a fresh decoder makes of bytes
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+        QStringDecoder d(encoding,(firstDecode) ? QStringConverter::Flag::Default : QStringConverter::Flag::ConvertInitialBom);
+        const QString s=d.decode(bytes);
+        failure=d.hasError();
+#else
+        QScopedPointer<QTextDecoder> d(codec->makeDecoder((firstDecode) ? QTextCodec::DefaultConversion : QTextCodec::IgnoreHeader));
+        const QString s=d->toUnicode(bytes);
+        failure=d->hasFailure();
+#endif
+        return int(s.size());
+    }
+    inline int failurePosition(const QByteArray& bytes) const // where the first invalid sequence lands in the decoded chunk, a U+FFFD in the document does not count
+    {
+        int lo=1;
+        int hi=int(bytes.size());
+        bool failure=false;
+        while (lo < hi) // the shortest prefix that fails to decode
+        {
+            const int mid=(lo+hi)/2;
+            replay(bytes.left(mid),failure);
+            (failure) ? hi=mid : lo=mid+1;
+        }
+        return replay(bytes.left(lo-1),failure);
+    }
+    inline void consume(const QStringView& s)
+    {
+        consumedCharacters+=s.size();
+        consumedBytes+=byteLength(s);
+        const int n=int(s.lastIndexOf(QLatin1Char('\n')));
+        if (n < 0)
+        {
+            lastLineLength+=int(s.size());
+            return;
+        }
+        consumedLines+=int(s.count(QLatin1Char('\n')));
+        lastLineLength=int(s.size())-n-1;
+    }
+    inline qint64 byteLength(const QStringView& s) const
+    {
+        if (!utf8) return s.size() * qint64(sizeof(QChar));
+        qint64 n=0;
+        for (const QChar c : s)
+        {
+            const ushort u=c.unicode();
+            n+=(u < 0x80) ? 1 : (u < 0x800) ? 2 : (c.isHighSurrogate() || c.isLowSurrogate()) ? 2 : 3; // a surrogate pair is 4
+        }
+        return n;
+    }
+    inline const QDomLiteValidationResult result(const QStringView& data, const bool bytes)
+    {
+        QDomLiteValidationResult r;
+        if (failedAt < 0) return r;
+        r.error=message;
+        const QStringView before=data.left(failedAt);
+        const int n=int(before.lastIndexOf(QLatin1Char('\n')));
+        r.line=consumedLines+int(before.count(QLatin1Char('\n')))+1;
+        r.column=((n < 0) ? lastLineLength+failedAt : failedAt-n-1)+1;
+        r.offset=(bytes) ? consumedBytes+byteLength(before) : consumedCharacters+failedAt;
+        return r;
+    }
+    static inline bool isNameStart(const ushort u) { return (u >= 0x80) || (((u | 0x20) >= 'a') && ((u | 0x20) <= 'z')) || (u == '_') || (u == ':'); }
+    static inline bool isNameChar(const ushort u) { return isNameStart(u) || ((u >= '0') && (u <= '9')) || (u == '-') || (u == '.'); }
+    static inline bool isName(const QStringView& s)
+    {
+        if (s.isEmpty() || !isNameStart(s.at(0).unicode())) return false;
+        for (const QChar c : s) if (!isNameChar(c.unicode())) return false;
+        return true;
+    }
+    static inline int digitValue(const ushort u)
+    {
+        if ((u >= '0') && (u <= '9')) return u-'0';
+        if (((u | 0x20) >= 'a') && ((u | 0x20) <= 'f')) return (u | 0x20)-'a'+10;
+        return -1;
+    }
+    static inline int offsetIn(const QDomLiteTokenizer& t, const QStringView& s) { return int(s.data()-t.data.data()); }
+    inline bool checkCharacters(const QDomLiteTokenizer& t, const QStringView& s, const bool attribute) // markup characters and references
+    {
+        for (int i = 0; i < s.size(); i++)
+        {
+            const ushort u=s.at(i).unicode();
+            if ((u < 0x20) && (u != '\t') && (u != '\n') && (u != '\r')) return fail(QStringLiteral("Invalid character"),offsetIn(t,s)+i);
+            if (attribute && (u == '<')) return fail(QStringLiteral("'<' in attribute value"),offsetIn(t,s)+i);
+            if (u != '&') continue;
+            const int e=int(s.indexOf(QLatin1Char(';'),i+1));
+            if (e < 0) return fail(QStringLiteral("Unterminated entity reference"),offsetIn(t,s)+i);
+            const QStringView ref=s.mid(i+1,e-i-1);
+            if (!checkReference(ref)) return fail(QStringLiteral("Undefined or malformed entity reference"),offsetIn(t,s)+i);
+            i=e;
+        }
+        return true;
+    }
+    inline bool checkReference(const QStringView& ref) const
+    {
+        if (ref.startsWith(QLatin1Char('#')))
+        {
+            const bool hex=ref.startsWith(QLatin1String("#x"));
+            const QStringView digits=ref.mid((hex) ? 2 : 1);
+            if (digits.isEmpty() || (digits.size() > 8)) return false;
+            const uint base=(hex) ? 16 : 10;
+            uint c=0;
+            for (const QChar d : digits)
+            {
+                const int v=digitValue(d.unicode());
+                if ((v < 0) || (uint(v) >= base)) return false;
+                c=c * base + uint(v);
+            }
+            return (c <= 0x10FFFF) && ((c >= 0x20) || (c == '\t') || (c == '\n') || (c == '\r'));
+        }
+        if ((ref == QLatin1String("amp")) || (ref == QLatin1String("lt")) || (ref == QLatin1String("gt")) || (ref == QLatin1String("quot")) || (ref == QLatin1String("apos"))) return true;
+        if (!isName(ref)) return false;
+        for (int i = 0; i < entities.size(); i++) if (arenaName(entityNames,entities,i) == ref) return true;
+        return false;
+    }
+    template <typename Starts>
+    static inline QStringView arenaName(const QString& arena, const Starts& starts, const int i) // the i-th name stored back to back in arena
+    {
+        const int end=(i+1 < starts.size()) ? starts.at(i+1) : int(arena.size());
+        return QStringView(arena).mid(starts.at(i),end-starts.at(i));
+    }
+    inline bool checkAttributes(const QDomLiteTokenizer& t)
+    {
+        const QStringView s=t.content;
+        QVarLengthArray<QStringView,16> names;
+        int position=0;
+        forever
+        {
+            while ((position < s.size()) && s.at(position).isSpace()) position++;
+            if (position >= s.size()) return true;
+            if ((position > 0) && !s.at(position-1).isSpace()) return fail(QStringLiteral("Missing whitespace between attributes"),offsetIn(t,s)+position);
+            const int start=position;
+            QStringView name;
+            QStringView value;
+            if (!QDomLiteTokenizer::nextAttribute(s,position,name,value) || !isName(name)) return fail(QStringLiteral("Malformed attribute"),offsetIn(t,s)+start);
+            for (const QStringView& n : names) if (n == name) return fail(QStringLiteral("Duplicate attribute"),offsetIn(t,s)+start);
+            names.append(name);
+            if (!checkCharacters(t,value,true)) return false;
+        }
+    }
+    inline void declareEntities(const QStringView& docType)
+    {
+        int i=0;
+        forever
+        {
+            i=int(docType.indexOf(QLatin1String("<!ENTITY"),i));
+            if (i < 0) return;
+            i+=8;
+            while ((i < docType.size()) && docType.at(i).isSpace()) i++;
+            const int start=i;
+            while ((i < docType.size()) && !docType.at(i).isSpace()) i++;
+            const QStringView name=docType.mid(start,i-start);
+            if (name == QLatin1String("%")) continue; // parameter entities are not referenced from content
+            entities.append(int(entityNames.size()));
+            entityNames.append(name);
+        }
+    }
+    inline bool scan(QDomLiteTokenizer& t)
+    {
+        forever
+        {
+            switch (t.next())
+            {
+            case QDomLiteTokenizer::NoToken:
+            case QDomLiteTokenizer::Incomplete:
+                return true;
+            case QDomLiteTokenizer::Invalid:
+                return fail(QStringLiteral("Unterminated or malformed markup"),t.tokenStart);
+            case QDomLiteTokenizer::StartElement:
+            case QDomLiteTokenizer::EmptyElement:
+                if (rootClosed) return fail(QStringLiteral("More than one document element"),t.tokenStart);
+                if (!isName(t.name)) return fail(QStringLiteral("Invalid element name"),t.tokenStart+1);
+                if (!checkAttributes(t)) return false;
+                rootSeen=true;
+                if (t.tokenType == QDomLiteTokenizer::StartElement)
+                {
+                    tags.append(int(tagNames.size()));
+                    tagNames.append(t.name);
+                }
+                else if (tags.isEmpty())
+                {
+                    rootClosed=true;
+                }
+                break;
+            case QDomLiteTokenizer::EndElement:
+                if (tags.isEmpty()) return fail(QStringLiteral("End tag without start tag"),t.tokenStart);
+                if (arenaName(tagNames,tags,tags.size()-1) != t.name) return fail(QStringLiteral("Mismatched end tag"),t.tokenStart);
+                tagNames.truncate(tags.last());
+                tags.removeLast();
+                if (tags.isEmpty()) rootClosed=true;
+                break;
+            case QDomLiteTokenizer::Text:
+                if (tags.isEmpty())
+                {
+                    if (!t.content.trimmed().isEmpty()) return fail(QStringLiteral("Text outside the document element"),t.tokenStart);
+                    break;
+                }
+                if (!checkCharacters(t,t.content,false)) return false;
+                break;
+            case QDomLiteTokenizer::CDATA:
+                if (tags.isEmpty()) return fail(QStringLiteral("CDATA outside the document element"),t.tokenStart);
+                break;
+            case QDomLiteTokenizer::Comment:
+                if (t.content.contains(QLatin1String("--"))) return fail(QStringLiteral("'--' inside comment"),t.tokenStart);
+                break;
+            case QDomLiteTokenizer::ProcessingInstruction:
+                if ((t.name.compare(QLatin1String("xml"),Qt::CaseInsensitive) == 0) && ((consumedCharacters > 0) || (t.tokenStart > 0)))
+                {
+                    return fail(QStringLiteral("XML declaration not at the start of the document"),t.tokenStart);
+                }
+                break;
+            case QDomLiteTokenizer::DocType:
+                if (rootSeen) return fail(QStringLiteral("DOCTYPE after the document element"),t.tokenStart);
+                declareEntities(t.content);
+                break;
+            }
+        }
+    }
+    inline void finish(const QDomLiteTokenizer& t)
+    {
+        if (!tags.isEmpty()) fail(QStringLiteral("Unclosed element at end of document"),int(t.data.size()));
+        else if (!rootSeen) fail(QStringLiteral("No document element"),int(t.data.size()));
+    }
+};
+
+namespace QDomLite
+{
+inline QDomLiteValidationResult validate(const QStringView& XML) { return QDomLiteValidator::validate(XML); }
+inline QDomLiteValidationResult validate(const QByteArray& XML) { return QDomLiteValidator::validate(XML); }
+inline QDomLiteValidationResult validate(QIODevice& device) { return QDomLiteValidator::validate(device); }
+}
+
+class QDomLiteRecordIndex
+{
+public:
+    inline QDomLiteRecordIndex() {}
+    inline QDomLiteRecordIndex(const QString& path, const QString& keyAttribute=QString()) { open(path,keyAttribute); }
+    inline ~QDomLiteRecordIndex() { close(); }
+    static inline const QString indexPath(const QString& path) { return path+QStringLiteral(".qdlidx"); }
+    inline bool open(const QString& path, const QString& keyAttribute=QString()) // uses the persisted index if it is current, else builds and saves it
+    {
+        if (load(path) && (this->keyAttribute == keyAttribute) && openSource()) return true;
+        if (!build(path,keyAttribute)) return false;
+        save();
+        return true;
+    }
+    inline bool build(const QString& path, const QString& keyAttribute=QString())
+    {
+        close();
+        sourcePath=path;
+        this->keyAttribute=keyAttribute;
+        if (!openSource()) return false;
+        const char* s=sourceData();
+        const qint64 size=sourceSize;
+        if ((size >= 2) && ((uchar(s[0]) == 0xFE) || (uchar(s[0]) == 0xFF) || (s[0] == 0) || (s[1] == 0))) return false; // only UTF-8, ASCII and Latin-1
+        int depth=0;
+        qint64 recordStart=-1;
+        qint64 i=0;
+        while (i < size)
+        {
+            if (s[i] != '<')
+            {
+                const void* lt=memchr(s+i,'<',size_t(size-i));
+                if (!lt) break;
+                i=static_cast<const char*>(lt)-s;
+                continue;
+            }
+            qint64 e;
+            if (startsWith(s,i,size,"<!--"))
+            {
+                e=find(s,i+4,size,"-->");
+                if (e < 0) return false;
+                i=e+3;
+            }
+            else if (startsWith(s,i,size,"<![CDATA["))
+            {
+                e=find(s,i+9,size,"]]>");
+                if (e < 0) return false;
+                i=e+3;
+            }
+            else if (startsWith(s,i,size,"<?"))
+            {
+                e=find(s,i+2,size,"?>");
+                if (e < 0) return false;
+                i=e+2;
+            }
+            else if (startsWith(s,i,size,"<!"))
+            {
+                e=tagEnd(s,i,size,true);
+                if (e < 0) return false;
+                i=e+1;
+            }
+            else if (startsWith(s,i,size,"</"))
+            {
+                e=tagEnd(s,i,size,false);
+                if (e < 0) return false;
+                i=e+1;
+                if (--depth == 1) appendRecord(recordStart,i);
+                if (depth == 0) break; // the document element is closed
+            }
+            else
+            {
+                e=tagEnd(s,i,size,false);
+                if (e < 0) return false;
+                const bool empty=(s[e-1] == '/');
+                if (depth == 1) recordStart=i;
+                i=e+1;
+                if (!empty)
+                {
+                    depth++;
+                }
+                else if (depth == 1)
+                {
+                    appendRecord(recordStart,i);
+                }
+            }
+        }
+        const QFileInfo info(path);
+        sourceModified=info.lastModified().toMSecsSinceEpoch();
+        buildKeyLookup();
+        return (depth == 0);
+    }
+    inline bool save(const QString& path=QString()) const
+    {
+        QFile file((path.isEmpty()) ? indexPath(sourcePath) : path);
+        if (!file.open(QIODevice::WriteOnly)) return false;
+        QDataStream ds(&file);
+        ds.setVersion(QDataStream::Qt_5_15);
+        ds << quint32(magic) << quint32(version) << sourceSize << sourceModified << keyAttribute << offsets << lengths << keys;
+        return (ds.status() == QDataStream::Ok);
+    }
+    inline bool load(const QString& path) // reads the persisted index of path, fails if it is missing or stale
+    {
+        close();
+        QFile file(indexPath(path));
+        if (!file.open(QIODevice::ReadOnly)) return false;
+        QDataStream ds(&file);
+        ds.setVersion(QDataStream::Qt_5_15);
+        quint32 m=0;
+        quint32 v=0;
+        ds >> m >> v;
+        if ((m != magic) || (v != version)) return false;
+        ds >> sourceSize >> sourceModified >> keyAttribute >> offsets >> lengths >> keys;
+        const QFileInfo info(path);
+        if ((ds.status() != QDataStream::Ok) || (info.size() != sourceSize) || (info.lastModified().toMSecsSinceEpoch() != sourceModified))
         {
-            const auto RemarkMatch = rxRemark.matchView(XML, Ptr);
-            if (RemarkMatch.capturedStart() != Ptr) break;
-            comments.append(QDomLite::valueFromString(RemarkMatch.captured(1)));
-            Ptr += RemarkMatch.capturedLength();
-            retVal=true;
+            close();
+            return false;
         }
-        return retVal;
+        sourcePath=path;
+        buildKeyLookup();
+        return true;
+    }
+    inline void close()
+    {
+        if (mapped) source.unmap(mapped);
+        mapped=nullptr;
+        source.close();
+        sourceBytes.clear();
+        offsets.clear();
+        lengths.clear();
+        keys.clear();
+        keyLookup.clear();
+    }
+    inline int count() const { return offsets.size(); }
+    inline qint64 offset(const int index) const { return offsets.at(index); }
+    inline qint64 length(const int index) const { return lengths.at(index); }
+    inline const QString key(const int index) const { return (index < keys.size()) ? keys.at(index) : QString(); }
+    inline int indexOfKey(const QString& key) const { return keyLookup.value(key,-1); }
+    inline const QString elementStringAt(const int index) const
+    {
+        if ((index < 0) || (index >= offsets.size()) || !sourceData()) return QString();
+        return decode(sourceData()+offsets.at(index),lengths.at(index));
+    }
+    inline QDomLiteElement* loadElementAt(const int index) const // the caller owns the returned element
+    {
+        const QString XML=elementStringAt(index);
+        if (XML.isEmpty()) return nullptr;
+        auto e=new QDomLiteElement;
+        e->fromString(XML);
+        return e;
+    }
+    inline QDomLiteElement* loadElementByKey(const QString& key) const { return loadElementAt(indexOfKey(key)); }
+private:
+    static const quint32 magic=0x51444c49;
+    static const quint32 version=1;
+    QString sourcePath;
+    QString keyAttribute;
+    qint64 sourceSize=0;
+    qint64 sourceModified=0;
+    QList<qint64> offsets;
+    QList<qint64> lengths;
+    QStringList keys;
+    QHash<QString,int> keyLookup; // built with the index, so lookups never write
+    QFile source;
+    uchar* mapped=nullptr;
+    QByteArray sourceBytes;
+    bool latin1=false;
+    inline bool openSource()
+    {
+        source.setFileName(sourcePath);
+        if (!source.open(QIODevice::ReadOnly)) return false;
+        sourceSize=source.size();
+        mapped=source.map(0,sourceSize);
+        if (!mapped) sourceBytes=source.readAll(); // mapping is not available everywhere
+        return detectEncoding();
+    }
+    inline bool detectEncoding() // reads the encoding of the XML declaration, fails for encodings the index can not decode
+    {
+        latin1=false;
+        QByteArray head=QByteArray::fromRawData(sourceData(),int(qMin<qint64>(sourceSize,256)));
+        if (head.startsWith("\xEF\xBB\xBF")) head=head.mid(3);
+        if (!head.startsWith("<?xml")) return true;
+        const int end=head.indexOf("?>");
+        int i=head.indexOf("encoding");
+        if ((i < 0) || ((end >= 0) && (i > end))) return true;
+        i+=8;
+        while ((i < head.size()) && ((head.at(i) == ' ') || (head.at(i) == '='))) i++;
+        if (i >= head.size()) return false;
+        const char quote=head.at(i);
+        const int close=head.indexOf(quote,i+1);
+        if (close < 0) return false;
+        const QByteArray encoding=head.mid(i+1,close-i-1).toLower();
+        if ((encoding == "utf-8") || (encoding == "utf8") || (encoding == "us-ascii") || (encoding == "ascii")) return true;
+        latin1=((encoding == "iso-8859-1") || (encoding == "iso8859-1") || (encoding == "latin1") || (encoding == "latin-1"));
+        return latin1;
+    }
+    inline QString decode(const char* s, const qint64 length) const { return (latin1) ? QString::fromLatin1(s,int(length)) : QString::fromUtf8(s,int(length)); }
+    inline void buildKeyLookup()
+    {
+        keyLookup.clear();
+        for (int i = keys.size() - 1; i >= 0; i--) keyLookup.insert(keys.at(i),i); // the first record wins for duplicate keys
+    }
+    inline const char* sourceData() const { return (mapped) ? reinterpret_cast<const char*>(mapped) : sourceBytes.constData(); }
+    inline void appendRecord(const qint64 start, const qint64 end)
+    {
+        offsets.append(start);
+        lengths.append(end-start);
+        if (keyAttribute.isEmpty()) return;
+        const char* s=sourceData();
+        const QString tag=decode(s+start+1,tagEnd(s,start,end,false)-start-1);
+        int position=int(QDomLiteTokenizer::tagName(tag).size());
+        QStringView name;
+        QStringView value;
+        QDomLiteValue k;
+        while (QDomLiteTokenizer::nextAttribute(tag,position,name,value))
+        {
+            if (name.compare(keyAttribute) != 0) continue;
+            k.fromEncodedString(value);
+            break;
+        }
+        keys.append(k);
+    }
+    static inline bool startsWith(const char* s, const qint64 i, const qint64 size, const char* prefix)
+    {
+        const qint64 n=qint64(strlen(prefix));
+        return (size-i >= n) && (memcmp(s+i,prefix,size_t(n)) == 0);
+    }
+    static inline qint64 find(const char* s, qint64 i, const qint64 size, const char* needle)
+    {
+        const qint64 n=qint64(strlen(needle));
+        while (i+n <= size)
+        {
+            const void* p=memchr(s+i,needle[0],size_t(size-i-n+1));
+            if (!p) return -1;
+            i=static_cast<const char*>(p)-s;
+            if (memcmp(s+i,needle,size_t(n)) == 0) return i;
+            i++;
+        }
+        return -1;
+    }
+    static inline qint64 tagEnd(const char* s, qint64 i, const qint64 size, const bool declaration) // position of the closing '>', quote aware
+    {
+        char quote=0;
+        int subset=0;
+        for (i++; i < size; i++)
+        {
+            const char c=s[i];
+            if (quote)
+            {
+                if (c == quote) quote=0;
+            }
+            else if ((c == '"') || (c == '\'')) quote=c;
+            else if (declaration && (c == '[')) subset++;
+            else if (declaration && (c == ']')) subset--;
+            else if ((c == '>') && (subset <= 0)) return i;
+        }
+        return -1;
+    }
+};
+
+class QDomLitePatch
+{
+public:
+    enum OperationType
+    {
+        InsertChild=0,
+        RemoveChild=1,
+        MoveChild=2,
+        SetAttribute=3,
+        RemoveAttribute=4,
+        SetText=5,
+        ReplaceElement=6
+    };
+    struct Operation
+    {
+        OperationType type=InsertChild;
+        QList<int> path; // child indexes from the root to the element the operation works on
+        int index=-1; // child index for insert, remove and move
+        int to=-1; // move destination, counted after the child is taken out
+        QString name;
+        QDomLiteValue value;
+        QSharedPointer<QDomLiteElement> element; // inserted or replacing subtree
+    };
+    QList<Operation> operations;
+    inline bool isEmpty() const { return operations.isEmpty(); }
+    inline int size() const { return operations.size(); }
+    inline void clear() { operations.clear(); }
+    inline bool apply(QDomLiteElement* root) const // operations are applied in order, paths refer to the tree as it is at that point
+    {
+        if (!root) return false;
+        for (const Operation& o : operations)
+        {
+            if (((o.type == InsertChild) || (o.type == ReplaceElement)) && !o.element) return false;
+            if ((o.type == ReplaceElement) && o.path.isEmpty())
+            {
+                root->copy(o.element.data());
+                continue;
+            }
+            const bool childOperation=(o.type == InsertChild) || (o.type == RemoveChild) || (o.type == MoveChild) || (o.type == ReplaceElement);
+            QDomLiteElement* e=resolve(root,(o.type == ReplaceElement) ? o.path.mid(0,o.path.size()-1) : o.path);
+            if (!e) return false;
+            const int index=(o.type == ReplaceElement) ? o.path.last() : o.index;
+            if (childOperation && (index < 0 || index > e->childCount() || ((o.type != InsertChild) && (index == e->childCount())))) return false;
+            switch (o.type)
+            {
+            case InsertChild:
+                e->insertChild(o.element->clone(),index);
+                break;
+            case RemoveChild:
+                e->removeChild(index);
+                break;
+            case MoveChild:
+                e->insertChild(e->takeChild(index),o.to);
+                break;
+            case ReplaceElement:
+                e->replaceChild(index,o.element->clone());
+                break;
+            case SetAttribute:
+            {
+                const int i=e->indexOfAttribute(o.name);
+                if (i < 0) e->appendAttribute(o.name,o.value);
+                else e->attributes.at(i)->value=o.value;
+                break;
+            }
+            case RemoveAttribute:
+                e->removeAttribute(o.name);
+                break;
+            case SetText:
+                e->expand(); // a pending body would overwrite the text later
+                e->text=o.value;
+                break;
+            }
+        }
+        return true;
+    }
+    inline void toDocument(QDomLiteDocument& document) const
+    {
+        document.clear(QStringLiteral("QDomLitePatch"),QStringLiteral("patch"));
+        for (const Operation& o : operations)
+        {
+            auto e=document.documentElement->appendChild(operationNames().at(o.type));
+            e->appendAttribute(QStringLiteral("path"),pathString(o.path));
+            if (o.index > -1) e->appendAttribute(QStringLiteral("index"),o.index);
+            if (o.to > -1) e->appendAttribute(QStringLiteral("to"),o.to);
+            if (!o.name.isEmpty()) e->appendAttribute(QStringLiteral("name"),o.name);
+            if ((o.type == SetAttribute) || (o.type == SetText)) e->appendAttribute(QStringLiteral("value"),o.value);
+            if (o.element) e->appendClone(o.element.data());
+        }
+    }
+    inline bool fromDocument(const QDomLiteDocument& document)
+    {
+        clear();
+        if (document.documentElement->tag != QLatin1String("patch")) return false; // also what an unparsed string leaves
+        for (const auto e : document.documentElement->childElements)
+        {
+            const int type=operationNames().indexOf(e->tag);
+            if (type < 0) return false;
+            Operation o;
+            o.type=OperationType(type);
+            for (const QString& i : e->attribute(QStringLiteral("path")).split('/',Qt::SkipEmptyParts)) o.path.append(i.toInt());
+            o.index=e->attributeValueInt(QStringLiteral("index"),-1);
+            o.to=e->attributeValueInt(QStringLiteral("to"),-1);
+            o.name=e->attribute(QStringLiteral("name"));
+            o.value=e->attribute(QStringLiteral("value"));
+            if (e->childCount()) o.element.reset(e->firstChild()->clone());
+            else if ((o.type == InsertChild) || (o.type == ReplaceElement)) return false;
+            operations.append(o);
+        }
+        return true;
+    }
+    inline const QString toString(const bool indent=false) const
+    {
+        QDomLiteDocument document;
+        toDocument(document);
+        return document.toString(indent);
+    }
+    inline bool fromString(const QString& XML)
+    {
+        QDomLiteDocument document;
+        return document.fromString(XML) && fromDocument(document);
+    }
+private:
+    static inline const QStringList& operationNames()
+    {
+        static const QStringList names({"insert","remove","move","attribute","removeattribute","text","replace"});
+        return names;
+    }
+    static inline const QString pathString(const QList<int>& path)
+    {
+        QStringList l;
+        for (const int i : path) l.append(QString::number(i));
+        return l.join('/');
+    }
+    static inline QDomLiteElement* resolve(QDomLiteElement* e, const QList<int>& path)
+    {
+        for (const int i : path)
+        {
+            if (!e) return nullptr;
+            e=e->childElement(i);
+        }
+        return e;
+    }
+};
+
+class QDomLiteDiff
+{
+public:
+    inline QDomLitePatch diff(const QDomLiteElement* from, const QDomLiteElement* to)
+    {
+        QDomLitePatch patch;
+        hashes.clear();
+        if (!from || !to) return patch;
+        QList<int> path;
+        if ((from->tag != to->tag) || !sameLeaf(from,to)) replace(patch,path,to);
+        else if (hash(from) != hash(to) || !equal(from,to)) diffElements(patch,path,from,to);
+        hashes.clear();
+        return patch;
+    }
+private:
+    QHash<const QDomLiteElement*,quint64> hashes;
+    static inline quint64 combine(const quint64 h, const quint64 v) { return (h ^ v) * 1099511628211ULL; }
+    inline quint64 hash(const QDomLiteElement* e)
+    {
+        const auto it=hashes.constFind(e);
+        if (it != hashes.constEnd()) return *it;
+        e->expand();
+        quint64 h=combine(14695981039346656037ULL,qHash(e->tag));
+        h=combine(h,qHash(e->text));
+        h=combine(h,qHash(e->CDATA()));
+        for (const QDomLiteValue& c : e->comments()) h=combine(h,qHash(c));
+        for (const auto a : e->attributes) h=combine(combine(h,qHash(a->name)),qHash(a->value));
+        for (const auto c : e->childElements) h=combine(h,hash(c));
+        hashes.insert(e,h);
+        return h;
+    }
+    static inline bool sameLeaf(const QDomLiteElement* a, const QDomLiteElement* b) // what the patch operations cannot change in place
+    {
+        return (a->CDATA() == b->CDATA()) && (a->comments() == b->comments());
+    }
+    static inline bool equal(const QDomLiteElement* a, const QDomLiteElement* b)
+    {
+        a->expand();
+        b->expand();
+        if ((a->tag != b->tag) || (a->text != b->text) || !sameLeaf(a,b)) return false;
+        if ((a->attributeCount() != b->attributeCount()) || (a->childCount() != b->childCount())) return false;
+        for (int i = 0; i < a->attributeCount(); i++)
+        {
+            if ((a->attributeName(i) != b->attributeName(i)) || (a->attribute(i) != b->attribute(i))) return false;
+        }
+        for (int i = 0; i < a->childCount(); i++) if (!equal(a->childElement(i),b->childElement(i))) return false;
+        return true;
+    }
+    static inline void replace(QDomLitePatch& patch, const QList<int>& path, const QDomLiteElement* e)
+    {
+        QDomLitePatch::Operation o;
+        o.type=QDomLitePatch::ReplaceElement;
+        o.path=path;
+        o.element.reset(e->clone());
+        patch.operations.append(o);
+    }
+    static inline void append(QDomLitePatch& patch, const QDomLitePatch::OperationType type, const QList<int>& path, const int index=-1, const int to=-1)
+    {
+        QDomLitePatch::Operation o;
+        o.type=type;
+        o.path=path;
+        o.index=index;
+        o.to=to;
+        patch.operations.append(o);
+    }
+    static inline QList<int> longestIncreasing(const QList<int>& l) // indexes into l
+    {
+        QList<int> tails;
+        QList<int> previous(l.size(),-1);
+        for (int i = 0; i < l.size(); i++)
+        {
+            int lo=0;
+            int hi=tails.size();
+            while (lo < hi)
+            {
+                const int mid=(lo+hi)/2;
+                (l.at(tails.at(mid)) < l.at(i)) ? lo=mid+1 : hi=mid;
+            }
+            if (lo > 0) previous[i]=tails.at(lo-1);
+            (lo == tails.size()) ? tails.append(i) : void(tails[lo]=i);
+        }
+        QList<int> RetVal;
+        for (int i = (tails.isEmpty()) ? -1 : tails.last(); i > -1; i=previous.at(i)) RetVal.prepend(i);
+        return RetVal;
+    }
+    inline void diffElements(QDomLitePatch& patch, const QList<int>& path, const QDomLiteElement* a, const QDomLiteElement* b)
+    {
+        a->expand();
+        b->expand();
+        for (const auto attr : b->attributes)
+        {
+            const int i=a->indexOfAttribute(attr->name);
+            if ((i > -1) && (a->attributes.at(i)->value == attr->value)) continue;
+            append(patch,QDomLitePatch::SetAttribute,path);
+            patch.operations.last().name=attr->name;
+            patch.operations.last().value=attr->value;
+        }
+        for (const auto attr : a->attributes)
+        {
+            if (b->attributeExists(attr->name)) continue;
+            append(patch,QDomLitePatch::RemoveAttribute,path);
+            patch.operations.last().name=attr->name;
+        }
+        if (a->text != b->text)
+        {
+            append(patch,QDomLitePatch::SetText,path);
+            patch.operations.last().value=b->text;
+        }
+        const QDomLiteElementList& A=a->childElements;
+        const QDomLiteElementList& B=b->childElements;
+        QList<int> match(B.size(),-1); // index in A of the child each child of B keeps
+        QList<bool> used(A.size(),false);
+        QHash<quint64,QList<int>> byHash;
+        for (int i = A.size() - 1; i >= 0; i--) byHash[hash(A.at(i))].append(i);
+        for (int j = 0; j < B.size(); j++) // unchanged subtrees
+        {
+            auto it=byHash.find(hash(B.at(j)));
+            if (it == byHash.end()) continue;
+            for (int k = it->size() - 1; k >= 0; k--)
+            {
+                const int i=it->at(k);
+                if (!equal(A.at(i),B.at(j))) continue;
+                match[j]=i;
+                used[i]=true;
+                it->removeAt(k);
+                break;
+            }
+        }
+        QHash<QString,QList<int>> byTag;
+        for (int i = A.size() - 1; i >= 0; i--) if (!used.at(i)) byTag[A.at(i)->tag].append(i);
+        for (int j = 0; j < B.size(); j++) // changed in place, paired by tag in document order
+        {
+            if (match.at(j) > -1) continue;
+            auto it=byTag.find(B.at(j)->tag);
+            if ((it == byTag.end()) || it->isEmpty()) continue;
+            match[j]=it->takeLast();
+            used[match.at(j)]=true;
+        }
+        for (int i = A.size() - 1; i >= 0; i--) if (!used.at(i)) append(patch,QDomLitePatch::RemoveChild,path,i);
+        QList<int> current; // surviving children of a, by their index in b
+        QList<int> order(A.size(),-1);
+        for (int j = 0; j < B.size(); j++) if (match.at(j) > -1) order[match.at(j)]=j;
+        for (int i = 0; i < A.size(); i++) if (order.at(i) > -1) current.append(order.at(i));
+        QList<bool> stays(B.size(),false);
+        for (const int i : longestIncreasing(current)) stays[current.at(i)]=true;
+        int previousKept=-1;
+        for (int j = 0; j < B.size(); j++) // moves, in b order, each behind its predecessor in b
+        {
+            if (match.at(j) < 0) continue;
+            if (!stays.at(j))
+            {
+                const int from=current.indexOf(j);
+                current.removeAt(from);
+                const int to=(previousKept < 0) ? 0 : current.indexOf(previousKept)+1;
+                current.insert(to,j);
+                append(patch,QDomLitePatch::MoveChild,path,from,to);
+            }
+            previousKept=j;
+        }
+        for (int j = 0; j < B.size(); j++) // inserts, in b order, land at their final index
+        {
+            if (match.at(j) > -1) continue;
+            append(patch,QDomLitePatch::InsertChild,path,j);
+            patch.operations.last().element.reset(B.at(j)->clone());
+        }
+        for (int j = 0; j < B.size(); j++)
+        {
+            const int i=match.at(j);
+            if ((i < 0) || (hash(A.at(i)) == hash(B.at(j)) && equal(A.at(i),B.at(j)))) continue;
+            QList<int> childPath(path);
+            childPath.append(j);
+            if (!sameLeaf(A.at(i),B.at(j))) replace(patch,childPath,B.at(j));
+            else diffElements(patch,childPath,A.at(i),B.at(j));
+        }
+    }
+};
+
+namespace QDomLite
+{
+inline QDomLitePatch diff(const QDomLiteElement* from, const QDomLiteElement* to)
+{
+    QDomLiteDiff d;
+    return d.diff(from,to);
+}
+inline bool applyPatch(QDomLiteElement* element, const QDomLitePatch& patch) { return patch.apply(element); }
+}
+
+inline bool QDomLiteDocument::fromCompressed(QIODevice& device, const QDomLiteCompressedDevice::Format format)
+{
+    QDomLiteCompressedDevice source(&device,format);
+    if (!source.open(QIODevice::ReadOnly)) return false;
+    QDomLitePushParser parser(this);
+    while (!source.atEnd())
+    {
+        const QByteArray chunk=source.read(XMLasyncchunksize);
+        if (chunk.isEmpty()) break;
+        if (!parser.feed(chunk)) return false;
+    }
+    return parser.finish() && !source.hasError();
+}
+
+inline bool QDomLiteDocument::load(const QString& path, const QDomLiteProjection& projection)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const auto format=QDomLiteCompressedDevice::detect(file.peek(4));
+    QDomLiteCompressedDevice decompressor(&file,format);
+    if ((format != QDomLiteCompressedDevice::Uncompressed) && !decompressor.open(QIODevice::ReadOnly)) return false;
+    QIODevice* source=(decompressor.isOpen()) ? static_cast<QIODevice*>(&decompressor) : &file;
+    QDomLitePushParser parser(this,projection);
+    while (!source->atEnd())
+    {
+        const QByteArray chunk=source->read(XMLasyncchunksize);
+        if (chunk.isEmpty()) break;
+        if (!parser.feed(chunk)) return false;
+    }
+    return parser.finish() && !decompressor.hasError();
+}
+
+inline bool QDomLiteDocument::fromString(const XMLStringClass& XML)
+{
+#ifdef QDOMLITE_STATISTICS
+    std::optional<QDomLiteStatisticsScope> statisticsScope;
+    if (QDomLite::activeStatistics() != &parseStatistics) statisticsScope.emplace(parseStatistics,QDomLiteStatistics::Parse,statisticsCallback);
+#endif
+    QDomLitePushParser parser(this);
+    const bool RetVal=parser.parse(XML);
+#ifdef QDOMLITE_STATISTICS
+    parseStatistics.charactersConsumed=XML.size();
+    if (parseStatistics.bytesConsumed == 0) parseStatistics.bytesConsumed=XML.size()*qint64(sizeof(QChar));
+#endif
+    return RetVal;
+}
+
+inline bool QDomLiteDocument::fromByteArray(const QByteArray& byteArray)
+{
+#ifdef QDOMLITE_STATISTICS
+    const QDomLiteStatisticsScope statisticsScope(parseStatistics,QDomLiteStatistics::Parse,statisticsCallback);
+    parseStatistics.bytesConsumed=byteArray.size();
+#endif
+    QDomLitePushParser parser(this);
+    return parser.feed(byteArray) && parser.finish();
+}
+
+inline bool QDomLiteDocument::fromString(const XMLStringClass& XML, const QDomLiteProjection& projection)
+{
+    QDomLitePushParser parser(this,projection);
+    return parser.parse(XML);
+}
+
+inline void QDomLiteNamePool::intern(QDomLiteElement* element)
+{
+    QDomLiteStringPool local; // names seen in this tree, so the shared pool is locked once per distinct name
+    internNames(element,local);
+}
+
+inline void QDomLiteNamePool::intern(QDomLiteDocument* document) { intern(document->documentElement); }
+
+inline void QDomLiteNamePool::internNames(QDomLiteElement* element, QDomLiteStringPool& local) // expands pending lazy bodies
+{
+    element->expand();
+    internLocal(element->tag,local);
+    for (auto a : element->attributes) internLocal(a->name,local);
+    for (const auto e : std::as_const(element->childElements)) internNames(e,local);
+}
+
+#ifdef QDOMLITE_ASYNC
+namespace QDomLite
+{
+inline int progressShift(const qint64 size) // progress is an int, large files report in scaled units
+{
+    int shift=0;
+    while ((size >> shift) > std::numeric_limits<int>::max()) shift++;
+    return shift;
+}
+inline int elementCount(const QDomLiteElement* e) // expands pending bodies, the writer would anyway
+{
+    e->expand();
+    int RetVal=1;
+    for (const auto c : e->childElements) RetVal+=elementCount(c);
+    return RetVal;
+}
+}
+
+inline QFuture<bool> QDomLiteDocument::loadAsync(const QString& path, const int chunkSize)
+{
+    return QtConcurrent::run([this,path,chunkSize](QPromise<bool>& promise)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            promise.addResult(false);
+            return;
+        }
+        const int shift=QDomLite::progressShift(file.size());
+        promise.setProgressRange(0,int(file.size() >> shift));
+        QDomLiteDocument loaded;
+        loaded.setParseOptions(parsingOptions);
+        QDomLitePushParser parser(&loaded); // fed chunk by chunk as it is read, the tree is the one load builds
+        const auto format=QDomLiteCompressedDevice::detect(file.peek(4));
+        QDomLiteCompressedDevice decompressor(&file,format);
+        const bool compressed=(format != QDomLiteCompressedDevice::Uncompressed);
+        if (compressed && !decompressor.open(QIODevice::ReadOnly)) // the codec is not built in, the data is not parsed as text
+        {
+            promise.addResult(false);
+            return;
+        }
+        QIODevice* source=(compressed) ? static_cast<QIODevice*>(&decompressor) : &file;
+        bool RetVal=true;
+        while (!source->atEnd())
+        {
+            promise.suspendIfRequested();
+            if (promise.isCanceled()) return;
+            const QByteArray chunk=source->read(chunkSize);
+            if (chunk.isEmpty()) break;
+            if (!parser.feed(chunk))
+            {
+                RetVal=false;
+                break;
+            }
+            promise.setProgressValue(int(file.pos() >> shift)); // bytes of the file read so far
+        }
+        if (promise.isCanceled()) return;
+        RetVal=RetVal && parser.finish() && !decompressor.hasError();
+        if (RetVal) swap(loaded); // the document is only replaced by a complete parse
+        promise.addResult(RetVal);
+    });
+}
+
+inline QFuture<bool> QDomLiteDocument::saveAsync(const QString& path, const bool indent, const int chunkSize) const
+{
+    return QtConcurrent::run([this,path,indent,chunkSize](QPromise<bool>& promise)
+    {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            promise.addResult(false);
+            return;
+        }
+        const auto format=QDomLiteCompressedDevice::savingFormat(path);
+        QDomLiteCompressedDevice compressor(&file,format);
+        if ((format != QDomLiteCompressedDevice::Uncompressed) && !compressor.open(QIODevice::WriteOnly))
+        {
+            file.cancelWriting();
+            promise.addResult(false);
+            return;
+        }
+        const int total=QDomLite::elementCount(documentElement);
+        promise.setProgressRange(0,total);
+        QIODevice* target=(compressor.isOpen()) ? static_cast<QIODevice*>(&compressor) : &file;
+        QDomLiteWriter writer(target,indent,chunkSize); // streams chunk by chunk, the document statistics are left alone
+        writer.setFlushCallback([&promise,&writer,total]()
+        {
+            promise.setProgressValue(qMin(writer.elementsWritten(),total));
+            promise.suspendIfRequested();
+            return !promise.isCanceled();
+        });
+        writer.writeDocument(*this);
+        compressor.close(); // writes the end of the compressed stream
+        if (promise.isCanceled() || writer.hasError() || compressor.hasError())
+        {
+            file.cancelWriting(); // leaves an existing file untouched
+            if (!promise.isCanceled()) promise.addResult(false);
+            return;
+        }
+        promise.setProgressValue(total);
+        promise.addResult(file.commit());
+    });
+}
+
+typedef QList<QDomLiteDocument*> QDomLiteDocumentList;
+
+class QDomLiteBatchLoader // parses many documents on a thread pool, each worker reads its own input
+{
+public:
+    typedef std::function<void(int index, QDomLiteDocument* document)> Callback; // called on the worker thread, the document is handed over
+    inline QDomLiteBatchLoader(QThreadPool* pool = QThreadPool::globalInstance()) : threadPool(pool) {}
+    inline void setNamePool(QDomLiteNamePool* pool) { namePool=(pool) ? pool : &ownNamePool; }
+    inline QDomLiteNamePool* sharedNamePool() const { return namePool; }
+    inline void setParseOptions(const QDomLiteParseOptions& options) { parseOptions=options; }
+    inline QDomLiteDocumentList load(const QStringList& paths) // in the order of paths, nullptr for files that could not be read
+    {
+        QDomLiteDocumentList RetVal(paths.size(),nullptr);
+        load(paths,[&RetVal](int index, QDomLiteDocument* document) { RetVal[index]=document; });
+        return RetVal;
+    }
+    inline void load(const QStringList& paths, const Callback& callback)
+    {
+        run(int(paths.size()),[&paths](QDomLiteDocument* document, int index) { return document->load(paths.at(index)); },callback);
+    }
+    inline QDomLiteDocumentList fromByteArrays(const QList<QByteArray>& buffers)
+    {
+        QDomLiteDocumentList RetVal(buffers.size(),nullptr);
+        fromByteArrays(buffers,[&RetVal](int index, QDomLiteDocument* document) { RetVal[index]=document; });
+        return RetVal;
+    }
+    inline void fromByteArrays(const QList<QByteArray>& buffers, const Callback& callback)
+    {
+        run(int(buffers.size()),[&buffers](QDomLiteDocument* document, int index)
+        {
+            QBuffer buffer;
+            buffer.setData(buffers.at(index)); // implicitly shared, not copied
+            return document->fromFile(buffer);
+        },callback);
+    }
+private:
+    Q_DISABLE_COPY(QDomLiteBatchLoader) // namePool may point into this object
+    QThreadPool* threadPool;
+    QDomLiteNamePool ownNamePool;
+    QDomLiteNamePool* namePool=&ownNamePool;
+    QDomLiteParseOptions parseOptions;
+    template <typename Parse>
+    inline void run(const int count, Parse parse, const Callback& callback)
+    {
+        QList<int> indexes(count);
+        std::iota(indexes.begin(),indexes.end(),0);
+        QtConcurrent::blockingMap(threadPool,indexes,[&](const int index)
+        {
+            const QDomLiteNamePoolScope nameScope(namePool); // tags and attribute names come from the pool as they are parsed
+            auto document=new QDomLiteDocument;
+            document->setParseOptions(parseOptions);
+            if (!parse(document,index))
+            {
+                delete document;
+                document=nullptr;
+            }
+            callback(index,document);
+        });
     }
 };
+#endif
 
 namespace QDomLite
 {
-inline const QDomLiteElement elementFromString(const QString& s) {
+inline QDomLiteElement elementFromString(const QString& s) {
     QDomLiteElement e;
     e.fromString(s);
     return e;
 }
 }
 
-#pragma pack(pop)
-
 #endif // QDOMLITE_H